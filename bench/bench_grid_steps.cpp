@@ -0,0 +1,46 @@
+// Random walk speed of the grids
+//
+// Usage: bench_grid_steps [rows cols [runs]]
+//
+// Runs CreateMazeWilson on each grid type and prints the random walk steps per second. Each step calls
+// getOpenEdgeMask, nextNode, getNode and setEdge of the grid, so this mostly measures the grid accessors.
+
+#include "src/brick_maze.h"
+#include "src/gen_wilson.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+template< typename Maze >
+static void measure(const char* name, int rows, int cols, int runs) {
+    auto seconds = 0.0;
+    auto steps = 0LL;
+    for (int run = 0; run < runs; run++) {
+        Maze m(rows, cols);
+        CreateMazeWilson<Maze> maze_gen(run + 1);
+        const auto start = std::chrono::steady_clock::now();
+        if (maze_gen.createMaze(m) != ECreateMazeResult::Ok) {
+            fprintf(stderr, "Maze generation failed\n");
+            exit(1);
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        steps += maze_gen.stats().wilson_steps;
+    }
+    printf("%-12s %12lld steps %10.2f Msteps/s\n", name, steps / runs, steps / seconds / 1e6);
+}
+
+int main(int argc, char** argv) {
+    const auto rows = argc > 2 ? atoi(argv[1]) : 500;
+    const auto cols = argc > 2 ? atoi(argv[2]) : 500;
+    const auto runs = argc > 3 ? atoi(argv[3]) : 5;
+
+    printf("%dx%d grids (%d cells), %d runs\n", rows, cols, rows * cols, runs);
+    measure<HexMaze>("HexMaze", rows, cols, runs);
+    measure<SquareMaze>("SquareMaze", rows, cols, runs);
+    measure<BrickMaze>("BrickMaze", rows, cols, runs);
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Memory footprint and speed of the grid state storage
+//
+// Usage: bench_matrix_storage [rows cols [runs]]
+//
+// Runs CreateMazeWilson on a square grid (same layout as SquareMaze) with the node and edge states stored
+// in Matrix<int> (the former SquareMaze/BrickMaze layout), Matrix<char> (the former HexMaze layout) and
+// PackedMatrix<2> (the current layout of all grids). The last run adds the open edge masks the grids keep
+// next to the states (OpenEdgeMasks), the others compute the masks from the states. Prints the size of the
+// state matrices (and masks) and the random walk steps per second. Use a grid that does not fit in the
+// cache with the wide layouts to see the difference.
+
+#include "src/gen_wilson.h"
+#include "src/grid_topology.h"
+#include "src/matrix.h"
+#include "src/node_index_2d.h"
+#include "src/open_node_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+static constexpr int STATE_OPEN = 0;
+static constexpr int STATE_ONPATH = 2;
+static constexpr int STATE_INVALID = 3;
+
+// Edge slots and neighbours of SquareMaze, used for the open edge masks
+static constexpr GridTopology<4, 1> TOPOLOGY = {
+    EGridParity::None,
+    2,
+    {
+        {{0, 0}, {1, 2}, {1, 3}, {0, 2}, {1, 1}},
+    },
+    {
+        {{0, 0}, {1, 0}, {0, 1}, {-1, 0}, {0, -1}},
+    },
+};
+
+// Minimal square grid with exchangeable state storage, optionally keeping the open edge masks
+template< typename StateMatrix, bool KeepMasks = false >
+class StorageGrid
+{
+public:
+    using NodeIndex = NodeIndex2D;
+    using EdgeIndex = int;
+
+    StorageGrid(int rows, int cols)
+        : rows_(rows)
+        , cols_(cols)
+        , nodes_(rows, cols)
+        , edges_(rows+1, 2*(cols+2))
+        , open_nodes_(rows*cols)
+        , masks_(rows, cols)
+    {
+        for (int i = 0; i <= rows; i++) {
+            for (int j = 0; j < 2*(cols+2); j++) {
+                edges_[i][j] = STATE_INVALID;
+            }
+        }
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                if (i < rows - 1) edge(i, j, 1) = STATE_OPEN;
+                if (j < cols - 1) edge(i, j, 2) = STATE_OPEN;
+            }
+        }
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                for (int e = 1; e <= 4; e++) {
+                    masks_.update(TOPOLOGY, i, j, e, STATE_OPEN, edge(i, j, e));
+                }
+            }
+        }
+    }
+
+    ENode getNode(NodeIndex node) const { return static_cast<ENode>(static_cast<int>(nodes_[node.i][node.j])); }
+
+    void setNode(NodeIndex node, ENode val) {
+        nodes_[node.i][node.j] = static_cast<int>(val);
+        if (val == ENode::Open) {
+            open_nodes_.insert(node.i*cols_ + node.j);
+        } else {
+            open_nodes_.erase(node.i*cols_ + node.j);
+        }
+    }
+
+    EdgeMask getOpenEdgeMask(NodeIndex node) const {
+        if constexpr (KeepMasks) {
+            return masks_.get(node);
+        }
+        EdgeMask mask = 0;
+        for (int e = 1; e <= 4; e++) {
+            const int state = edge(node.i, node.j, e);
+            if (state == STATE_OPEN || state == STATE_ONPATH) {
+                mask |= 1 << e;
+            }
+        }
+        return mask;
+    }
+
+    void setEdge(NodeIndex node, EdgeIndex e, EEdge val) {
+        auto&& state = edge(node.i, node.j, e);
+        if constexpr (KeepMasks) {
+            masks_.update(TOPOLOGY, node.i, node.j, e, state, static_cast<int>(val));
+        }
+        state = static_cast<int>(val);
+    }
+
+    NodeIndex getOpenNode() const {
+        const auto id = open_nodes_.first();
+        return id < 0 ? invalidNode() : NodeIndex{id / cols_, id % cols_};
+    }
+
+    static NodeIndex nextNode(NodeIndex node, EdgeIndex e) {
+        switch (e) {
+            case 1: return {node.i + 1, node.j};
+            case 2: return {node.i, node.j + 1};
+            case 3: return {node.i - 1, node.j};
+            default: return {node.i, node.j - 1};
+        }
+    }
+
+    static NodeIndex invalidNode() { return {-1, -1}; }
+
+    size_t memoryUsage() const {
+        return storageSize(nodes_) + storageSize(edges_) + (KeepMasks ? masks_.memoryUsage() : 0);
+    }
+
+private:
+    // Same edge slots as the E1..E4 macros of SquareMaze
+    decltype(auto) edge(int i, int j, int e) {
+        switch (e) {
+            case 1: return edges_[i+1][2*j + 2];
+            case 2: return edges_[i+1][2*j + 3];
+            case 3: return edges_[i][2*j + 2];
+            default: return edges_[i+1][2*j + 1];
+        }
+    }
+    int edge(int i, int j, int e) const {
+        switch (e) {
+            case 1: return edges_[i+1][2*j + 2];
+            case 2: return edges_[i+1][2*j + 3];
+            case 3: return edges_[i][2*j + 2];
+            default: return edges_[i+1][2*j + 1];
+        }
+    }
+
+    template< typename T >
+    static size_t storageSize(const Matrix<T>& m) { return static_cast<size_t>(m.rows()) * m.cols() * sizeof(T); }
+    template< int Bits >
+    static size_t storageSize(const PackedMatrix<Bits>& m) { return m.memoryUsage(); }
+
+    int rows_;
+    int cols_;
+    StateMatrix nodes_;
+    StateMatrix edges_;
+    OpenNodeIndex open_nodes_;
+    OpenEdgeMasks<4> masks_;
+};
+
+template< typename StateMatrix, bool KeepMasks = false >
+static void measure(const char* name, int rows, int cols, int runs) {
+    auto seconds = 0.0;
+    auto steps = 0LL;
+    size_t memory = 0;
+    for (int run = 0; run < runs; run++) {
+        StorageGrid<StateMatrix, KeepMasks> m(rows, cols);
+        memory = m.memoryUsage();
+        CreateMazeWilson<StorageGrid<StateMatrix, KeepMasks>> maze_gen(run + 1);
+        const auto start = std::chrono::steady_clock::now();
+        if (maze_gen.createMaze(m) != ECreateMazeResult::Ok) {
+            fprintf(stderr, "Maze generation failed\n");
+            exit(1);
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        steps += maze_gen.stats().wilson_steps;
+    }
+    printf("%-16s %10.2f MiB %10.2f Msteps/s\n", name, memory / (1024.0 * 1024.0), steps / seconds / 1e6);
+}
+
+int main(int argc, char** argv) {
+    const auto rows = argc > 2 ? atoi(argv[1]) : 2000;
+    const auto cols = argc > 2 ? atoi(argv[2]) : 2000;
+    const auto runs = argc > 3 ? atoi(argv[3]) : 3;
+
+    printf("Square grid %dx%d (%d cells), %d runs\n", rows, cols, rows * cols, runs);
+    printf("%-16s %14s %19s\n", "storage", "states", "speed");
+    measure<Matrix<int>>("Matrix<int>", rows, cols, runs);
+    measure<Matrix<char>>("Matrix<char>", rows, cols, runs);
+    measure<PackedMatrix<2>>("PackedMatrix<2>", rows, cols, runs);
+    measure<PackedMatrix<2>, true>("+ edge masks", rows, cols, runs);
+    return 0;
+}
@@ -0,0 +1,44 @@
+// SVG writing speed
+//
+// Usage: bench_svg_painter [rows cols [runs]]
+//
+// Draws a generated HexMaze with SvgPainter into a memory stream and prints the output size and the
+// throughput, the maze is generated once outside of the measure.
+
+#include "src/hexmaze.h"
+#include "src/svg_painter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <sstream>
+
+int main(int argc, char** argv) {
+    const auto rows = argc > 2 ? atoi(argv[1]) : 500;
+    const auto cols = argc > 2 ? atoi(argv[2]) : 500;
+    const auto runs = argc > 3 ? atoi(argv[3]) : 5;
+
+    HexMaze m(rows, cols);
+    m.AddExits();
+    if (m.CreateMaze({}, nullptr) != ECreateMazeResult::Ok) {
+        fprintf(stderr, "Maze generation failed\n");
+        return 1;
+    }
+    const DrawParams p = {10, 10, 1};
+
+    auto seconds = 0.0;
+    auto bytes = 0.0;
+    for (int run = 0; run < runs; run++) {
+        std::ostringstream os;
+        const auto start = std::chrono::steady_clock::now();
+        {
+            SvgPainter painter(os, {1});
+            m.Draw(painter, p);
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        bytes += static_cast<double>(os.tellp());
+    }
+    printf("%dx%d HexMaze: %.1f MB, %.1f MB/s\n", rows, cols, bytes / runs / 1e6, bytes / seconds / 1e6);
+    return 0;
+}
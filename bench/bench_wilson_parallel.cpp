@@ -0,0 +1,68 @@
+// Thread-count scaling of CreateMazeWilsonParallel
+//
+// Usage: bench_wilson_parallel [rows cols [max_threads [runs]]]
+//
+// Generates hexagonal mazes with 1, 2, 4, ... max_threads threads and prints the wall clock time and the
+// speedup relative to the sequential CreateMazeWilson. CreateMazeWilsonArrows is timed as well, it is
+// sequential too and generates the same mazes. The running time of Wilson's algorithm has a heavy
+// tail, so each configuration is timed over `runs` different seeds.
+
+#include "src/gen_wilson.h"
+#include "src/gen_wilson_arrows.h"
+#include "src/gen_wilson_parallel.h"
+#include "src/hexmaze.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <thread>
+
+template< typename CreateMaze >
+static double measure(int rows, int cols, int runs, CreateMaze create_maze) {
+    auto total = 0.0;
+    for (int run = 0; run < runs; run++) {
+        HexMaze m(rows, cols);
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = create_maze(m, static_cast<unsigned>(run + 1));
+        const auto end = std::chrono::steady_clock::now();
+        if (result != ECreateMazeResult::Ok) {
+            fprintf(stderr, "Maze generation failed\n");
+            exit(1);
+        }
+        total += std::chrono::duration<double>(end - start).count();
+    }
+    return total;
+}
+
+int main(int argc, char** argv) {
+    const auto rows = argc > 2 ? atoi(argv[1]) : 1000;
+    const auto cols = argc > 2 ? atoi(argv[2]) : 1000;
+    const auto hw_threads = static_cast<int>(std::thread::hardware_concurrency());
+    const auto max_threads = argc > 3 ? atoi(argv[3]) : (hw_threads > 0 ? hw_threads : 1);
+    const auto runs = argc > 4 ? atoi(argv[4]) : 5;
+
+    printf("HexMaze %dx%d (%d cells), %d runs\n", rows, cols, rows * cols, runs);
+
+    const auto t_seq = measure(rows, cols, runs, [](HexMaze& m, unsigned seed) {
+        CreateMazeWilson<HexMaze> maze_gen(seed);
+        return maze_gen.createMaze(m);
+    });
+    printf("%-12s %10.3f s\n", "sequential", t_seq);
+
+    const auto t_arrows = measure(rows, cols, runs, [](HexMaze& m, unsigned seed) {
+        CreateMazeWilsonArrows<HexMaze> maze_gen(seed);
+        return maze_gen.createMaze(m);
+    });
+    printf("%-12s %10.3f s  speedup %5.2fx\n", "arrows", t_arrows, t_seq / t_arrows);
+
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        const auto t = measure(rows, cols, runs, [num_threads](HexMaze& m, unsigned seed) {
+            CreateMazeWilsonParallel<HexMaze> maze_gen(seed, num_threads);
+            return maze_gen.createMaze(m);
+        });
+        printf("%3d threads  %10.3f s  speedup %5.2fx\n", num_threads, t, t_seq / t);
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "animated_svg_painter.h"
+
+#include <assert.h>
+
+using namespace std;
+
+namespace {
+
+// Splits a style attribute ("name:value;name:value") into its properties
+vector<pair<string, string>> splitStyle(const string& style) {
+    vector<pair<string, string>> properties;
+    size_t pos = 0;
+    while (pos < style.size()) {
+        auto end = style.find(';', pos);
+        if (end == string::npos) {
+            end = style.size();
+        }
+        const auto colon = style.find(':', pos);
+        assert(colon < end);
+        properties.emplace_back(style.substr(pos, colon - pos), style.substr(colon + 1, end - colon - 1));
+        pos = end + 1;
+    }
+    return properties;
+}
+
+} // namespace
+
+AnimatedSvgPainter::AnimatedSvgPainter(const PainterParams& params) {
+    for (int style = 0; style < STYLE_COUNT; style++) {
+        attributes_[style] = splitStyle(svgStyle(static_cast<EStyle>(style), params));
+    }
+}
+
+void AnimatedSvgPainter::BeginDraw(int width, int height) {
+    width_ = width;
+    height_ = height;
+}
+
+void AnimatedSvgPainter::EndDraw() {
+    // The elements drawn earlier but not in this frame disappear
+    for (auto& element : elements_) {
+        if (element.drawn_frame != frame_count_ && element.changes.back().style != HIDDEN) {
+            element.changes.push_back({frame_count_, HIDDEN});
+        }
+    }
+    frame_count_++;
+}
+
+void AnimatedSvgPainter::DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) {
+    const Point2D points[] = {p1, p2};
+    draw(true, points, 2, style);
+}
+
+void AnimatedSvgPainter::DrawPoly(const vector<Point2D>& vertices, EStyle style) {
+    draw(false, vertices.data(), vertices.size(), style);
+}
+
+void AnimatedSvgPainter::draw(bool is_line, const Point2D* points, size_t count, EStyle style) {
+    key_.assign(1, is_line ? 'L' : 'P');
+    key_.append(reinterpret_cast<const char*>(points), count * sizeof(Point2D));
+    auto [it, inserted] = index_.try_emplace(key_, static_cast<int>(elements_.size()));
+    if (inserted) {
+        elements_.push_back({is_line, vector<Point2D>(points, points + count), {}, -1});
+    }
+
+    auto& element = elements_[it->second];
+    assert(element.drawn_frame != frame_count_);
+    element.drawn_frame = frame_count_;
+    if (element.changes.empty() || element.changes.back().style != static_cast<int>(style)) {
+        element.changes.push_back({frame_count_, static_cast<int>(style)});
+    }
+}
+
+void AnimatedSvgPainter::Write(ostream& os, double frame_duration) const {
+    os << "<!DOCTYPE svg>\n";
+    os << "<svg height=\"" << height_ << "\" width=\"" << width_ << "\" xmlns=\"http://www.w3.org/2000/svg\" style=\"background-color:white\">\n";
+    for (const auto& element : elements_) {
+        // The element starts with the style it is drawn with first, hidden until then
+        auto style = element.changes.front().style;
+        auto visible = element.changes.front().frame == 0;
+        if (element.is_line) {
+            os << "<line x1=\"" << element.points[0].x
+               << "\" y1=\"" << element.points[0].y
+               << "\" x2=\"" << element.points[1].x
+               << "\" y2=\"" << element.points[1].y << '"';
+        } else {
+            os << "<polygon points=\"";
+            for (const auto v : element.points) {
+                os << v.x << ',' << v.y << ' ';
+            }
+            os << '"';
+        }
+        for (const auto& [name, value] : attributes_[style]) {
+            os << ' ' << name << "=\"" << value << '"';
+        }
+        if (!visible) {
+            os << " visibility=\"hidden\"";
+        }
+        if (element.changes.size() == 1 && visible) {
+            os << " />\n";
+            continue;
+        }
+        os << ">\n";
+
+        const auto set = [&os, frame_duration](int frame, const char* attribute, const string& value) {
+            os << "<set attributeName=\"" << attribute << "\" to=\"" << value << "\" begin=\""
+               << frame * frame_duration << "s\" fill=\"freeze\" />\n";
+        };
+        for (const auto& change : element.changes) {
+            if (change.style == HIDDEN) {
+                set(change.frame, "visibility", "hidden");
+                visible = false;
+                continue;
+            }
+            if (!visible) {
+                set(change.frame, "visibility", "visible");
+                visible = true;
+            }
+            if (change.style != style) {
+                // The cells and the lines have the same attributes in all of their styles
+                const auto& from = attributes_[style];
+                const auto& to = attributes_[change.style];
+                assert(from.size() == to.size());
+                for (size_t k = 0; k < to.size(); k++) {
+                    assert(from[k].first == to[k].first);
+                    if (from[k].second != to[k].second) {
+                        set(change.frame, to[k].first.c_str(), to[k].second);
+                    }
+                }
+                style = change.style;
+            }
+        }
+        os << (element.is_line ? "</line>\n" : "</polygon>\n");
+    }
+    os << "</svg>\n";
+}
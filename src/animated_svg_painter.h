@@ -0,0 +1,72 @@
+#pragma once
+
+#include "painter.h"
+#include "svg_painter.h"
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Painter collecting the frames of an animation, written as a single animated SVG (see Write)
+//
+// Each frame is drawn as a whole, between BeginDraw and EndDraw. The cells and walls are identified by
+// their geometry, and each of them is written once, with a <set> element for every frame its style
+// changes in or it appears or disappears (it is not drawn in the frame). So the file grows with the
+// number of changes between the frames, not with the number of frames, and changes reverted before the
+// next frame (e.g. walks erased as loops) are not written at all.
+//
+// The styles are written as presentation attributes (fill, stroke...), only the ones that change are set.
+// The style attribute itself is not animatable.
+class AnimatedSvgPainter : public IPainter
+{
+public:
+    explicit AnimatedSvgPainter(const PainterParams& params);
+
+    AnimatedSvgPainter(const AnimatedSvgPainter&) = delete;
+    AnimatedSvgPainter& operator=(const AnimatedSvgPainter&) = delete;
+
+    void BeginDraw(int width, int height) override;
+    void EndDraw() override;
+    void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) override;
+    void DrawPoly(const std::vector<Point2D>& vertices, EStyle style) override;
+
+    int frameCount() const { return frame_count_; }
+
+    // Writes the animation showing each frame for `frame_duration` seconds, the last one stays
+    void Write(std::ostream& os, double frame_duration) const;
+
+private:
+    // Not drawn in the frame
+    static constexpr int HIDDEN = -1;
+
+    struct Change
+    {
+        int frame;
+        int style; // EStyle or HIDDEN
+    };
+
+    struct Element
+    {
+        bool is_line;
+        std::vector<Point2D> points;
+        // The frames the element changes in, the first one is where it is drawn first
+        std::vector<Change> changes;
+        // Last frame the element was drawn in
+        int drawn_frame;
+    };
+
+    void draw(bool is_line, const Point2D* points, size_t count, EStyle style);
+
+    // svgStyle() of each style split into presentation attributes: name and value
+    std::vector<std::pair<std::string, std::string>> attributes_[STYLE_COUNT];
+    int width_ = 0;
+    int height_ = 0;
+    int frame_count_ = 0;
+    std::vector<Element> elements_;
+    // Index of each element in elements_ by its geometry
+    std::unordered_map<std::string, int> index_;
+    // Geometry of the element being drawn, the key in index_
+    std::string key_;
+};
@@ -1,6 +1,14 @@
 #include "brick_maze.h"
+#include "create_maze.h"
+#include "gen_region.h"
+#include "grid_topology.h"
+#include "maze_journal.h"
+#include "maze_solver.h"
 #include "svg_painter.h"
 
+#include <algorithm>
+#include <bit>
+
 using namespace std;
 
 using EStyle = IPainter::EStyle;
@@ -8,19 +16,39 @@ using EStyle = IPainter::EStyle;
 static constexpr auto NODE_OPEN = static_cast<int>(ENode::Open);
 static constexpr auto NODE_VISITED = static_cast<int>(ENode::Visited);
 static constexpr auto NODE_ONPATH = static_cast<int>(ENode::OnPath);
-static constexpr auto NODE_INVALID = -1;
+static constexpr auto NODE_INVALID = static_cast<int>(ENode::Invalid);
 
 static constexpr auto EDGE_OPEN = static_cast<int>(EEdge::Open);
 // static constexpr auto EDGE_VISITED = static_cast<int>(EEdge::Visited);
 static constexpr auto EDGE_ONPATH = static_cast<int>(EEdge::OnPath);
-static constexpr auto EDGE_INVALID = -1;
+static constexpr auto EDGE_INVALID = 3; // The states are stored in 2 bits
+
+// Edge slots and neighbours of BrickMaze. Edge directions: 1 SW, 2 SE, 3 E, 4 NE, 5 NW, 6 W
+static constexpr GridTopology<6, 2> TOPOLOGY = {
+    EGridParity::Row,
+    3,
+    {
+        {{0, 0}, {1, 3}, {1, 4}, {1, 5}, {0, 3}, {0, 1}, {1, 2}},           // Even rows
+        {{0, 0}, {1, 3}, {1, 4}, {1, 5}, {0, 6}, {0, 4}, {1, 2}},           // Odd rows
+    },
+    {
+        {{0, 0}, {1, -1}, {1, 0}, {0, 1}, {-1, 0}, {-1, -1}, {0, -1}},      // Even rows
+        {{0, 0}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {0, -1}},        // Odd rows
+    },
+};
+static_assert(TOPOLOGY.isConsistent());
+
+inline int BrickMaze::edgeState(int i, int j, EdgeIndex edge) const {
+    const auto slot = TOPOLOGY.edgeSlot(i, j, edge);
+    return edges_[slot.row][slot.col];
+}
 
-#define E1(i, j)    (edges_[i+1][3*j + 3])                                      // direction SW
-#define E2(i, j)    (edges_[i+1][3*j + 4])                                      // direction SE
-#define E3(i, j)    (edges_[i+1][3*j + 5])                                      // direction E
-#define E4(i, j)    ((i % 2) == 0 ? edges_[i][3*j + 3] : edges_[i][3*j + 6])    // direction NE
-#define E5(i, j)    ((i % 2) == 0 ? edges_[i][3*j + 1] : edges_[i][3*j + 4])    // direction NW
-#define E6(i, j)    (edges_[i+1][3*j + 2])                                      // direction W
+void BrickMaze::setEdgeState(int i, int j, EdgeIndex edge, int state) {
+    const auto slot = TOPOLOGY.edgeSlot(i, j, edge);
+    auto state_ref = edges_[slot.row][slot.col];
+    open_edge_masks_.update(TOPOLOGY, i, j, edge, state_ref, state);
+    state_ref = state;
+}
 
 struct PointParams
 {
@@ -41,10 +69,22 @@ BrickMaze::BrickMaze(int rows, int cols)
     , cols_(cols)
     , nodes_(rows, cols)
     , edges_(rows+1, 3*(cols+2))
+    , open_nodes_(rows*cols)
+    , open_edge_masks_(rows, cols)
 {
     invalidateRegionEdges({0, 0}, {rows-1, cols-1});
 }
 
+BrickMaze::~BrickMaze() = default;
+
+void BrickMaze::Reset() {
+    nodes_.clear();
+    edges_.clear();
+    open_nodes_.reset();
+    open_edge_masks_.reset();
+    invalidateRegionEdges({0, 0}, {rows_-1, cols_-1});
+}
+
 inline static bool isEdgeVisible(int edge) {
     return edge == EDGE_OPEN || edge == EDGE_INVALID;
 }
@@ -79,13 +119,6 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
 
     for (int i = 0; i < rows_; i++) {
         for (int j = 0; j < cols_; j++) {
-            const auto c = nodeCenter({i, j}, cell_width, cell_height, padding_x, padding_y);
-            const auto p = PointParams{c, cell_width, cell_height};
-            const auto p1{P1(p)};
-            const auto p3{P3(p)};
-            const auto p4{P4(p)};
-            const auto p6{P6(p)};
-
             EStyle style;
             switch (nodes_[i][j]) {
                 case NODE_OPEN: style = EStyle::OpenCell; break;
@@ -95,6 +128,17 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
                 default:
                     assert(0);
             }
+            if (!p.isCellDrawn(style)) {
+                continue;
+            }
+
+            const auto c = nodeCenter({i, j}, cell_width, cell_height, padding_x, padding_y);
+            const auto p = PointParams{c, cell_width, cell_height};
+            const auto p1{P1(p)};
+            const auto p3{P3(p)};
+            const auto p4{P4(p)};
+            const auto p6{P6(p)};
+
             painter.DrawPoly({p6, p4, p3, p1}, style);
         }
     }
@@ -109,8 +153,8 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p5{P5(p)};
             const auto p6{P6(p)};
 
-            const auto e5 = E5(i, j);
-            const auto e6 = E6(i, j);
+            const auto e5 = edgeState(i, j, 5);
+            const auto e6 = edgeState(i, j, 6);
             if (i > 0 && isEdgeVisible(e5)) { // skip top row
                 painter.DrawLine(p5, p6, edgeStyle(e5));
             }
@@ -121,7 +165,7 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p1{P1(p)};
             const auto p6{P6(p)};
 
-            const auto e6 = E6(i, j);
+            const auto e6 = edgeState(i, j, 6);
             if (isEdgeVisible(e6)) {
                 painter.DrawLine(p6, p1, edgeStyle(e6));
             }
@@ -137,7 +181,7 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p4{P4(p)};
             const auto p5{P5(p)};
 
-            const auto e4 = E4(i, j);
+            const auto e4 = edgeState(i, j, 4);
             if (isEdgeVisible(e4)) {
                 painter.DrawLine(p4, p5, edgeStyle(e4));
             }
@@ -154,13 +198,13 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p5{P5(p)};
         const auto p6{P6(p)};
 
-        const auto e4 = E4(i, j);
-        const auto e5 = E5(i, j);
+        const auto e4 = edgeState(i, j, 4);
+        const auto e5 = edgeState(i, j, 5);
         if (isEdgeVisible(e4)) {
             painter.DrawLine(p4, p5, edgeStyle(e4));
         }
         if (isEdgeVisible(e5)) {
-            painter.DrawLine(p5, p6, edgeStyle(e4));
+            painter.DrawLine(p5, p6, edgeStyle(e5));
         }
     }
 
@@ -178,9 +222,9 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p3{P3(p)};
             const auto p4{P4(p)};
 
-            const auto e1 = E1(i, j);
-            const auto e2 = E2(i, j);
-            const auto e3 = E3(i, j);
+            const auto e1 = edgeState(i, j, 1);
+            const auto e2 = edgeState(i, j, 2);
+            const auto e3 = edgeState(i, j, 3);
 
             if (isEdgeVisible(e1)) {
                 painter.DrawLine(p1, p2, edgeStyle(e1));
@@ -219,9 +263,9 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p3{P3(p)};
             const auto p4{P4(p)};
 
-            const char e1 = E1(i, j);
-            const char e2 = E2(i, j);
-            const char e3 = E3(i, j);
+            const char e1 = edgeState(i, j, 1);
+            const char e2 = edgeState(i, j, 2);
+            const char e3 = edgeState(i, j, 3);
             if (b1 && isEdgeVisible(e1)) {
                 painter.DrawLine(p1, p2, edgeStyle(e1));
             }
@@ -234,6 +278,18 @@ void BrickMaze::Draw(IPainter& painter, const DrawParams& p) const {
         }
     }
 
+    // Solution
+    if (p.show_solution) {
+        MazeSolver<BrickMaze> solver;
+        vector<NodeIndex> path;
+        if (solver.solve(*this, path)) {
+            for (size_t k = 1; k < path.size(); k++) {
+                painter.DrawLine(nodeCenter(path[k - 1], cell_width, cell_height, padding_x, padding_y),
+                                 nodeCenter(path[k], cell_width, cell_height, padding_x, padding_y), EStyle::Solution);
+            }
+        }
+    }
+
     painter.EndDraw();
 }
 
@@ -243,69 +299,42 @@ ENode BrickMaze::getNode(NodeIndex node) const {
 
 void BrickMaze::setNode(NodeIndex node, ENode val) {
     nodes_[node.i][node.j] = static_cast<int>(val);
+    if (val == ENode::Open) {
+        open_nodes_.insert(nodeId(node));
+    } else {
+        open_nodes_.erase(nodeId(node));
+    }
 }
 
 void BrickMaze::getOpenEdges(NodeIndex node, EdgeList& edges) const {
-    const auto i = node.i;
-    const auto j = node.j;
-    const auto e1 = E1(i, j);
-    const auto e2 = E2(i, j);
-    const auto e3 = E3(i, j);
-    const auto e4 = E4(i, j);
-    const auto e5 = E5(i, j);
-    const auto e6 = E6(i, j);
-
     edges.clear();
-    if (e1 == EDGE_OPEN || e1 == EDGE_ONPATH) edges.push_back(1);
-    if (e2 == EDGE_OPEN || e2 == EDGE_ONPATH) edges.push_back(2);
-    if (e3 == EDGE_OPEN || e3 == EDGE_ONPATH) edges.push_back(3);
-    if (e4 == EDGE_OPEN || e4 == EDGE_ONPATH) edges.push_back(4);
-    if (e5 == EDGE_OPEN || e5 == EDGE_ONPATH) edges.push_back(5);
-    if (e6 == EDGE_OPEN || e6 == EDGE_ONPATH) edges.push_back(6);
+    for (auto mask = getOpenEdgeMask(node); mask != 0; mask &= mask - 1) {
+        edges.push_back(std::countr_zero(mask));
+    }
 }
 
 void BrickMaze::setEdge(NodeIndex node, EdgeIndex edge, EEdge val) {
     const auto i = node.i;
     const auto j = node.j;
     const auto intval = static_cast<int>(val);
-    switch (edge) {
-        case 1: E1(i, j) = intval; break;
-        case 2: E2(i, j) = intval; break;
-        case 3: E3(i, j) = intval; break;
-        case 4: E4(i, j) = intval; break;
-        case 5: E5(i, j) = intval; break;
-        case 6: E6(i, j) = intval; break;
-        default:
-            assert(0);
-    }
+    assert(1 <= edge && edge <= 6);
+    setEdgeState(i, j, edge, intval);
 }
 
 EEdge BrickMaze::getEdge(NodeIndex node, EdgeIndex edge) const {
     const auto i = node.i;
     const auto j = node.j;
-    int intval = 0;
-    switch (edge) {
-        case 1: intval = E1(i, j); break;
-        case 2: intval = E2(i, j); break;
-        case 3: intval = E3(i, j); break;
-        case 4: intval = E4(i, j); break;
-        case 5: intval = E5(i, j); break;
-        case 6: intval = E6(i, j); break;
-        default:
-            assert(0);
-    }
+    assert(1 <= edge && edge <= 6);
+    const auto intval = edgeState(i, j, edge);
     return static_cast<EEdge>(intval);
 }
 
 BrickMaze::NodeIndex BrickMaze::getOpenNode() const {
-    for (int i = 0; i < nodes_.rows(); i++) {
-        for (int j = 0; j < nodes_.cols(); j++) {
-            if (nodes_[i][j] == EDGE_OPEN) {
-                return {i, j};
-            }
-        }
+    const auto id = open_nodes_.first();
+    if (id < 0) {
+        return invalidNode();
     }
-    return invalidNode();
+    return nodeFromId(id);
 }
 
 bool BrickMaze::nodeExists(NodeIndex node) const {
@@ -314,33 +343,10 @@ bool BrickMaze::nodeExists(NodeIndex node) const {
 }
 
 BrickMaze::NodeIndex BrickMaze::nextNode(NodeIndex node, EdgeIndex edge) {
-    const auto i = node.i;
-    const auto j = node.j;
-    switch (edge) {
-        case 1:
-            if ((i % 2) == 0)
-                return {i+1, j-1};
-            else
-                return {i+1, j};
-        case 2:
-            if ((i % 2) == 0)
-                return {i+1, j};
-            else
-                return {i+1, j+1};
-        case 3: return {i, j+1};
-        case 4:
-            if ((i % 2) == 0)
-                return {i-1, j};
-            else
-                return {i-1, j+1};
-        case 5:
-            if ((i % 2) == 0)
-                return {i-1, j-1};
-            else
-                return {i-1, j};
-        case 6: return {i, j-1};
+    if (edge < 1 || edge > 6) {
+        return invalidNode();
     }
-    return invalidNode();
+    return TOPOLOGY.nextNode(node.i, node.j, edge);
 }
 
 BrickMaze::NodeIndex BrickMaze::invalidNode() {
@@ -356,22 +362,22 @@ void BrickMaze::invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight)
             // Left vertical line
             const auto j = topLeft.j;
             if ((i % 2) == 0) {
-                E5(i, j) = EDGE_INVALID;
-                E6(i, j) = EDGE_INVALID;
-                E1(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 5, EDGE_INVALID);
+                setEdgeState(i, j, 6, EDGE_INVALID);
+                setEdgeState(i, j, 1, EDGE_INVALID);
             } else {
-                E6(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 6, EDGE_INVALID);
             }
         }
         {
             // Right vertical line
             const auto j = bottomRight.j;
             if ((i % 2) == 0) {
-                E3(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 3, EDGE_INVALID);
             } else {
-                E2(i, j) = EDGE_INVALID;
-                E3(i, j) = EDGE_INVALID;
-                E4(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 2, EDGE_INVALID);
+                setEdgeState(i, j, 3, EDGE_INVALID);
+                setEdgeState(i, j, 4, EDGE_INVALID);
             }
         }
     }
@@ -380,14 +386,14 @@ void BrickMaze::invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight)
         {
             // Top horizontal line
             const auto i = topLeft.i;
-            E4(i, j) = EDGE_INVALID;
-            E5(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 4, EDGE_INVALID);
+            setEdgeState(i, j, 5, EDGE_INVALID);
         }
         {
             // Bottom horizontal line
             const auto i = bottomRight.i;
-            E1(i, j) = EDGE_INVALID;
-            E2(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 1, EDGE_INVALID);
+            setEdgeState(i, j, 2, EDGE_INVALID);
         }
     }
 }
@@ -398,6 +404,7 @@ void BrickMaze::invalidateRegion(NodeIndex topLeft, NodeIndex bottomRight) {
     for (int i = topLeft.i; i <= bottomRight.i; i++) {
         for (int j = topLeft.j; j <= bottomRight.j; j++) {
             nodes_[i][j] = NODE_INVALID;
+            open_nodes_.erase(nodeId({i, j}));
         }
     }
 }
@@ -417,7 +424,45 @@ void BrickMaze::AddExits() {
     setEdge({rows_ - 1, cols_ - 1}, 2, EEdge::Visited);
 }
 
-ECreateMazeResult BrickMaze::CreateMaze(unsigned random_seed) {
-    CreateMazeWilson<BrickMaze> maze_gen(random_seed);
-    return maze_gen.createMaze(*this);
+void BrickMaze::AddLongestPathExits() {
+    addLongestPathExits(*this);
+}
+
+void BrickMaze::RecordLongestPathExits(MazeJournal& journal) {
+    addLongestPathExits(*this, JournalRecorder<BrickMaze>(journal, *this));
+}
+
+void BrickMaze::SetOpenNodeOrder(EOpenNodeOrder order, unsigned random_seed) {
+    open_nodes_.setOrder(order, random_seed);
+}
+
+ECreateMazeResult BrickMaze::CreateMaze(const CreateMazeParams& params, CreateMazeStats* stats) {
+    if (!generators_) {
+        generators_ = std::make_unique<MazeGenerators<BrickMaze>>();
+    }
+    return generators_->createMaze(*this, params, stats);
+}
+
+ECreateMazeResult BrickMaze::RecordMaze(const CreateMazeParams& params, CreateMazeStats* stats,
+                                        MazeJournal& journal) {
+    return createMaze(*this, params, stats, JournalRecorder<BrickMaze>(journal, *this));
+}
+
+void BrickMaze::DrawAnimation(IPainter& painter, const DrawParams& p, const MazeJournal& journal,
+                              int frame_count) {
+    drawJournalFrames(*this, journal, frame_count, painter, p);
+}
+
+void BrickMaze::RegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                                 CreateMazeStats* stats) {
+    regenerateRegion(*this, top_left, bottom_right, random_seed, stats);
+}
+
+void BrickMaze::RecordRegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                                       CreateMazeStats* stats, MazeJournal& journal) {
+    regenerateRegion(*this, top_left, bottom_right, random_seed, stats, JournalRecorder<BrickMaze>(journal, *this));
+}
+
+MazeMetrics BrickMaze::ComputeMetrics() const {
+    return computeMazeMetrics(*this);
 }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "gen_kruskal.h"
+#include "gen_wilson.h"
+#include "gen_wilson_arrows.h"
+#include "gen_wilson_parallel.h"
+#include "maze_grid.h"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Runs the maze generator selected by `params` on `maze`. The counters of the generator are copied to
+// `stats` unless it is null. The events of the generator are sent to `observer` (see NullMazeObserver),
+// CreateMazeWilsonParallel has no observer so a single thread is used with any other observer.
+template< typename Maze, typename Observer = NullMazeObserver >
+ECreateMazeResult createMaze(Maze& maze, const CreateMazeParams& params, CreateMazeStats* stats,
+                             Observer observer = Observer()) {
+    switch (params.algorithm) {
+        case EMazeAlgorithm::Wilson:
+            if (params.num_threads > 1 && std::is_same_v<Observer, NullMazeObserver>) {
+                CreateMazeWilsonParallel<Maze> maze_gen(params.random_seed, params.num_threads);
+                const auto result = maze_gen.createMaze(maze);
+                if (stats) {
+                    *stats = maze_gen.stats();
+                }
+                return result;
+            } else {
+                CreateMazeWilson<Maze, Pcg32, Observer> maze_gen(params.random_seed, std::move(observer));
+                const auto result = maze_gen.createMaze(maze);
+                if (stats) {
+                    *stats = maze_gen.stats();
+                }
+                return result;
+            }
+        case EMazeAlgorithm::WilsonArrows: {
+            CreateMazeWilsonArrows<Maze, Pcg32, Observer> maze_gen(params.random_seed, std::move(observer));
+            const auto result = maze_gen.createMaze(maze);
+            if (stats) {
+                *stats = maze_gen.stats();
+            }
+            return result;
+        }
+        case EMazeAlgorithm::Kruskal: {
+            CreateMazeKruskal<Maze, Observer> maze_gen(params.random_seed, std::move(observer));
+            if (stats) {
+                *stats = {};
+            }
+            return maze_gen.createMaze(maze);
+        }
+    }
+    assert(0);
+    return ECreateMazeResult::Ok;
+}
+
+// The maze generators of a grid, kept between its mazes (see IMazeGrid::Reset) so that a worker generating
+// many mazes on the same grid allocates the buffers of its generators once, not for every maze. A generator
+// is created by the first maze using it and reseeded for the next ones.
+template< typename Maze >
+class MazeGenerators
+{
+public:
+    // Same as createMaze() without an observer
+    ECreateMazeResult createMaze(Maze& maze, const CreateMazeParams& params, CreateMazeStats* stats);
+
+private:
+    // Returns `generator` reseeded with `random_seed`, it is created first if there is none
+    template< typename Generator, typename... Args >
+    static Generator& reuse(std::unique_ptr<Generator>& generator, unsigned random_seed, Args... args) {
+        if (generator) {
+            generator->reseed(random_seed);
+        } else {
+            generator = std::make_unique<Generator>(random_seed, args...);
+        }
+        return *generator;
+    }
+
+    std::unique_ptr<CreateMazeWilson<Maze>> wilson_;
+    std::unique_ptr<CreateMazeWilsonParallel<Maze>> wilson_parallel_;
+    std::unique_ptr<CreateMazeWilsonArrows<Maze>> wilson_arrows_;
+    std::unique_ptr<CreateMazeKruskal<Maze>> kruskal_;
+};
+
+template< typename Maze >
+ECreateMazeResult MazeGenerators<Maze>::createMaze(Maze& maze, const CreateMazeParams& params,
+                                                   CreateMazeStats* stats) {
+    const auto run = [&maze, stats](auto& maze_gen) {
+        const auto result = maze_gen.createMaze(maze);
+        if (stats) {
+            *stats = maze_gen.stats();
+        }
+        return result;
+    };
+    switch (params.algorithm) {
+        case EMazeAlgorithm::Wilson:
+            if (params.num_threads > 1) {
+                if (wilson_parallel_ && wilson_parallel_->numThreads() != params.num_threads) {
+                    wilson_parallel_.reset();
+                }
+                return run(reuse(wilson_parallel_, params.random_seed, params.num_threads));
+            } else {
+                return run(reuse(wilson_, params.random_seed));
+            }
+        case EMazeAlgorithm::WilsonArrows:
+            return run(reuse(wilson_arrows_, params.random_seed));
+        case EMazeAlgorithm::Kruskal: {
+            auto& maze_gen = reuse(kruskal_, params.random_seed);
+            if (stats) {
+                *stats = {};
+            }
+            return maze_gen.createMaze(maze);
+        }
+    }
+    assert(0);
+    return ECreateMazeResult::Ok;
+}
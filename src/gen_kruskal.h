@@ -0,0 +1,176 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "random.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <vector>
+
+// Randomized Kruskal's algorithm
+// https://en.wikipedia.org/wiki/Maze_generation_algorithm#Iterative_randomized_Kruskal's_algorithm_(with_sets)
+//
+// All open edges are collected into a flat array which is shuffled once. The edges are then added to the
+// maze in that order unless they would close a loop, which is checked with a union-find over the linear
+// node ids. The running time is near-linear in the number of nodes, but the spanning tree is not uniform
+// (mazes tend to have more short dead ends than the ones created by Wilson's algorithm).
+//
+// Nodes already visited are treated as a single tree, just like in CreateMazeWilson.
+//
+// The observer (see NullMazeObserver) receives the changes of the nodes and edges.
+//
+// Type parameter `Maze` is expected to implement:
+//  // Type to refer to nodes and edges
+//  using NodeIndex = ...;
+//  using EdgeIndex = ...;  // Convertible to int, valid edges are in the range [1, 7]
+//
+//  // Get/set node status
+//  ENode getNode(NodeIndex node) const;
+//  void setNode(NodeIndex node, ENode val);
+//
+//  // Return the open edges
+//  EdgeMask getOpenEdgeMask(NodeIndex node) const;
+//
+//  // Set edge status
+//  void setEdge(NodeIndex node, EdgeIndex edge, EEdge val);
+//
+//  // Return the adjacent node of `node` along `edge`
+//  static NodeIndex nextNode(NodeIndex node, EdgeIndex edge);
+//
+//  // Linear node ids (0 <= id < nodeCount())
+//  int nodeCount() const;
+//  int nodeId(NodeIndex node) const;
+//  NodeIndex nodeFromId(int id) const;
+//
+template< typename Maze, typename Observer = NullMazeObserver >
+class CreateMazeKruskal
+{
+public:
+    explicit CreateMazeKruskal(unsigned random_seed, Observer observer = Observer());
+
+    // Restarts the random engine with a new seed, so the generator and its buffers are reused for another maze
+    void reseed(unsigned random_seed) { random_engine_ = Pcg32(random_seed); }
+
+    ECreateMazeResult createMaze(Maze& maze);
+
+    Observer& observer() { return observer_; }
+
+private:
+    using NodeIndex = Maze::NodeIndex;
+    using EdgeIndex = Maze::EdgeIndex;
+
+    // An edge is packed into 32 bits: the id of one of its nodes and the edge index of that node
+    static constexpr int EDGE_BITS = 3;
+    static uint32_t packEdge(int id, EdgeIndex edge) { return (static_cast<uint32_t>(id) << EDGE_BITS) | edge; }
+    static int edgeNode(uint32_t packed) { return static_cast<int>(packed >> EDGE_BITS); }
+    static EdgeIndex edgeIndex(uint32_t packed) { return static_cast<EdgeIndex>(packed & ((1 << EDGE_BITS) - 1)); }
+
+    // Union-find: a negative value marks a root (minus the size of its set), other values are parent ids
+    int findSet(int id);
+    bool unionSets(int id1, int id2);
+
+    std::vector<uint32_t> edges_;
+    std::vector<int> sets_;
+
+    Pcg32 random_engine_;
+    [[no_unique_address]] Observer observer_;
+};
+
+template< typename Maze, typename Observer >
+CreateMazeKruskal<Maze, Observer>::CreateMazeKruskal(unsigned random_seed, Observer observer)
+    : random_engine_(random_seed)
+    , observer_(std::move(observer)) {}
+
+template< typename Maze, typename Observer >
+ECreateMazeResult CreateMazeKruskal<Maze, Observer>::createMaze(Maze& maze) {
+    if (maze.getOpenNode() == Maze::invalidNode()) {
+        return ECreateMazeResult::ErrNoFirstOpenNode;
+    }
+
+    const auto node_count = maze.nodeCount();
+    assert(node_count < (1 << (32 - EDGE_BITS)));
+    sets_.assign(node_count, -1);
+    edges_.clear();
+
+    auto first_visited = -1;
+    for (int id = 0; id < node_count; id++) {
+        const auto node = maze.nodeFromId(id);
+        const auto status = maze.getNode(node);
+        if (status == ENode::Visited) {
+            // All visited nodes are part of the same tree
+            if (first_visited < 0) {
+                first_visited = id;
+            } else {
+                unionSets(first_visited, id);
+            }
+            continue;
+        }
+        if (status != ENode::Open) {
+            continue;
+        }
+
+        // Collect every edge once, from the node with the smaller id
+        for (auto open_edges = maze.getOpenEdgeMask(node); open_edges != 0; open_edges &= open_edges - 1) {
+            const auto edge = static_cast<EdgeIndex>(std::countr_zero(open_edges));
+            assert(0 < edge && edge < (1 << EDGE_BITS));
+            const auto next_node = Maze::nextNode(node, edge);
+            const auto next_id = maze.nodeId(next_node);
+            if (next_id > id || maze.getNode(next_node) == ENode::Visited) {
+                edges_.push_back(packEdge(id, edge));
+            }
+        }
+    }
+
+    randomShuffle(edges_.begin(), edges_.end(), random_engine_);
+
+    for (const auto packed : edges_) {
+        const auto id = edgeNode(packed);
+        const auto edge = edgeIndex(packed);
+        const auto node = maze.nodeFromId(id);
+        if (unionSets(id, maze.nodeId(Maze::nextNode(node, edge)))) {
+            setEdgeObserved(maze, observer_, node, edge, EEdge::Visited);
+        }
+    }
+
+    for (int id = 0; id < node_count; id++) {
+        const auto node = maze.nodeFromId(id);
+        if (maze.getNode(node) == ENode::Open) {
+            setNodeObserved(maze, observer_, node, ENode::Visited);
+        }
+    }
+
+    return ECreateMazeResult::Ok;
+}
+
+template< typename Maze, typename Observer >
+int CreateMazeKruskal<Maze, Observer>::findSet(int id) {
+    // Path splitting: every node on the path is linked to its grandparent
+    while (sets_[id] >= 0) {
+        const auto parent = sets_[id];
+        if (sets_[parent] >= 0) {
+            sets_[id] = sets_[parent];
+        }
+        id = parent;
+    }
+    return id;
+}
+
+template< typename Maze, typename Observer >
+bool CreateMazeKruskal<Maze, Observer>::unionSets(int id1, int id2) {
+    auto root1 = findSet(id1);
+    auto root2 = findSet(id2);
+    if (root1 == root2) {
+        return false;
+    }
+    // Union by size, the smaller set is attached to the root of the larger one
+    if (sets_[root1] > sets_[root2]) {
+        std::swap(root1, root2);
+    }
+    sets_[root1] += sets_[root2];
+    sets_[root2] = root1;
+    return true;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "random.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <vector>
+
+// Regenerates the cells of a rectangular region of a generated maze, the rest of the maze is kept as it is
+//
+// The tree edges between two cells of the region are removed and new ones are added by loop-erased random
+// walks (in the last exit formulation, see CreateMazeWilsonArrows) restricted to the region. The edges
+// crossing the border of the region are kept, so the cells of the region may belong to several pieces
+// which are only connected through the rest of the maze. Each piece is spanned again on its own cells,
+// with walks that never leave it: joining two pieces inside the region would close a loop outside it.
+// The new edges of a piece form a uniform spanning tree of its cells.
+//
+// The observer (see NullMazeObserver) receives the start of every walk and the changes of the edges: the
+// removed tree edges first, then the new ones. The nodes are not changed.
+//
+// All the work is done on flat arrays the size of the region, indexed by the position of the cell in the
+// region, so the cost grows with the size of the region and not with the size of the grid.
+//
+// Type parameter `Maze` is expected to implement getNode, getEdge, setEdge and nextNode (see
+// CreateMazeWilson) plus:
+//  static constexpr int EDGE_COUNT;
+//  int rows() const;
+//  int cols() const;
+//
+template< typename Maze, typename RandomEngine = Pcg32, typename Observer = NullMazeObserver >
+class RegenerateRegionWilson
+{
+public:
+    using NodeIndex = Maze::NodeIndex;
+
+    explicit RegenerateRegionWilson(unsigned random_seed, Observer observer = Observer());
+
+    // Regenerates the visited cells of the rectangle from `top_left` to `bottom_right` (inclusive, clipped
+    // to the grid). Exits are kept.
+    void regenerate(Maze& maze, NodeIndex top_left, NodeIndex bottom_right);
+
+    // Counters of the last regenerate() call (walks and steps only)
+    const CreateMazeStats& stats() const { return stats_; }
+
+    Observer& observer() { return observer_; }
+
+private:
+    using EdgeIndex = Maze::EdgeIndex;
+
+    static_assert(Maze::EDGE_COUNT < 8, "The edges of a cell must fit in a byte");
+
+    // Position of `node` in the region, -1 if it is outside of it
+    int localId(NodeIndex node) const {
+        const auto i = node.i - top_;
+        const auto j = node.j - left_;
+        return (0 <= i && i < height_ && 0 <= j && j < width_) ? i * width_ + j : -1;
+    }
+    NodeIndex nodeFromLocalId(int id) const { return {top_ + id / width_, left_ + id % width_}; }
+
+    int top_ = 0;
+    int left_ = 0;
+    int height_ = 0;
+    int width_ = 0;
+    // Piece of each cell (the local id of its first cell), -1 for the cells not in the maze
+    std::vector<int> pieces_;
+    // Edges of each cell to the other cells of its piece, the only ones the walks take
+    std::vector<uint8_t> masks_;
+    // Exit edge of each cell left by the current walk (see CreateMazeWilsonArrows)
+    std::vector<uint8_t> arrows_;
+    // Cells already added back to the maze
+    std::vector<uint8_t> in_tree_;
+    std::vector<int> queue_;
+    CreateMazeStats stats_;
+
+    RandomEngine random_engine_;
+    [[no_unique_address]] Observer observer_;
+};
+
+template< typename Maze, typename RandomEngine, typename Observer >
+RegenerateRegionWilson<Maze, RandomEngine, Observer>::RegenerateRegionWilson(unsigned random_seed,
+                                                                             Observer observer)
+    : random_engine_(random_seed)
+    , observer_(std::move(observer)) {}
+
+template< typename Maze, typename RandomEngine, typename Observer >
+void RegenerateRegionWilson<Maze, RandomEngine, Observer>::regenerate(Maze& maze, NodeIndex top_left,
+                                                                      NodeIndex bottom_right) {
+    stats_ = {};
+    top_ = std::max(top_left.i, 0);
+    left_ = std::max(top_left.j, 0);
+    height_ = std::max(std::min(bottom_right.i, maze.rows() - 1) - top_ + 1, 0);
+    width_ = std::max(std::min(bottom_right.j, maze.cols() - 1) - left_ + 1, 0);
+    const auto size = height_ * width_;
+    pieces_.assign(size, -1);
+    masks_.assign(size, 0);
+    arrows_.assign(size, 0);
+    in_tree_.assign(size, 0);
+    queue_.resize(size);
+
+    // Find the pieces along the tree edges inside the region. The first cell of a piece is its root, the
+    // walks of the other cells end there.
+    for (int root = 0; root < size; root++) {
+        if (pieces_[root] >= 0 || maze.getNode(nodeFromLocalId(root)) != ENode::Visited) {
+            continue;
+        }
+        pieces_[root] = root;
+        in_tree_[root] = 1;
+        auto head = 0;
+        auto tail = 0;
+        queue_[tail++] = root;
+        while (head < tail) {
+            const auto node = nodeFromLocalId(queue_[head++]);
+            for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+                const auto next = localId(Maze::nextNode(node, edge));
+                if (next >= 0 && pieces_[next] < 0 && maze.getEdge(node, edge) == EEdge::Visited) {
+                    pieces_[next] = root;
+                    queue_[tail++] = next;
+                }
+            }
+        }
+    }
+
+    // Remove the tree edges inside the region
+    for (int id = 0; id < size; id++) {
+        if (pieces_[id] < 0) {
+            continue;
+        }
+        const auto node = nodeFromLocalId(id);
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            const auto next = localId(Maze::nextNode(node, edge));
+            if (next >= 0 && pieces_[next] == pieces_[id]) {
+                masks_[id] |= 1 << edge;
+                if (maze.getEdge(node, edge) == EEdge::Visited) {
+                    setEdgeObserved(maze, observer_, node, edge, EEdge::Open);
+                }
+            }
+        }
+    }
+
+    // Span each piece again, the walk from a cell ends at the root of its piece or a cell added before
+    for (int start = 0; start < size; start++) {
+        if (pieces_[start] < 0 || in_tree_[start]) {
+            continue;
+        }
+        stats_.wilson_walks++;
+        observer_.onEvent(WalkStartedEvent<NodeIndex>{nodeFromLocalId(start)});
+
+        auto id = start;
+        do {
+            assert(masks_[id] != 0);
+            const auto k = randomBelow(random_engine_, static_cast<uint32_t>(std::popcount(masks_[id])));
+            const auto edge = selectEdge(masks_[id], k);
+            arrows_[id] = static_cast<uint8_t>(edge);
+            id = localId(Maze::nextNode(nodeFromLocalId(id), static_cast<EdgeIndex>(edge)));
+            stats_.wilson_steps++;
+        } while (!in_tree_[id]);
+
+        for (id = start; !in_tree_[id];) {
+            const auto node = nodeFromLocalId(id);
+            const auto edge = static_cast<EdgeIndex>(arrows_[id]);
+            in_tree_[id] = 1;
+            setEdgeObserved(maze, observer_, node, edge, EEdge::Visited);
+            id = localId(Maze::nextNode(node, edge));
+        }
+    }
+}
+
+// Regenerates a region of a generated maze with RegenerateRegionWilson. The counters are copied to `stats`
+// unless it is null, the changes are reported to `observer`.
+template< typename Maze, typename Observer = NullMazeObserver >
+void regenerateRegion(Maze& maze, typename Maze::NodeIndex top_left, typename Maze::NodeIndex bottom_right,
+                      unsigned random_seed, CreateMazeStats* stats, Observer observer = Observer()) {
+    RegenerateRegionWilson<Maze, Pcg32, Observer> regen(random_seed, std::move(observer));
+    regen.regenerate(maze, top_left, bottom_right);
+    if (stats) {
+        *stats = regen.stats();
+    }
+}
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "random.h"
+
 #include <assert.h>
-#include <random>
+#include <stdint.h>
+
+#include <bit>
+#include <utility>
+#include <vector>
 
 #include <iostream>
 
@@ -10,6 +16,7 @@ enum class ENode
     Open,
     Visited,
     OnPath,
+    Invalid, // Node excluded from the maze (see invalidateRegion), never set by the generators
 };
 
 enum class EEdge
@@ -17,8 +24,21 @@ enum class EEdge
     Open,
     Visited,
     OnPath,
+    Invalid, // Edge excluded from the maze or to the outside of the grid, never set by the generators
 };
 
+// Set of edges of a node: bit `e` is set for edge `e` (valid edges start from 1)
+using EdgeMask = uint32_t;
+
+// Returns the `k`th (from 0) edge of `mask`, which must have more than `k` edges
+inline int selectEdge(EdgeMask mask, int k) {
+    assert(k < std::popcount(mask));
+    for (; k > 0; k--) {
+        mask &= mask - 1;
+    }
+    return std::countr_zero(mask);
+}
+
 enum class ECreateMazeResult
 {
     Ok,
@@ -26,6 +46,71 @@ enum class ECreateMazeResult
     ErrNoOpenEdges, // We reached a node which doesn't have any open edges
 };
 
+// Counters collected by the generators, mostly for tuning
+struct CreateMazeStats
+{
+    // Steps of the loop-erased random walks, including the erased ones
+    long long wilson_steps = 0;
+    // Number of loop-erased random walks
+    int wilson_walks = 0;
+};
+
+// Events reported by the generators to their observer policy
+template< typename NodeIndex >
+struct NodeChangedEvent
+{
+    NodeIndex node;
+    ENode state;
+};
+
+template< typename NodeIndex >
+struct EdgeChangedEvent
+{
+    NodeIndex node;
+    int edge;
+    EEdge state;
+};
+
+// A loop-erased random walk started at `node`
+template< typename NodeIndex >
+struct WalkStartedEvent
+{
+    NodeIndex node;
+};
+
+// The walk returned to `node`, which closed a loop of `length` steps. The steps were erased.
+template< typename NodeIndex >
+struct LoopErasedEvent
+{
+    NodeIndex node;
+    int length;
+};
+
+// Observer policy of the generators ignoring all events, the calls compile to nothing. This is the default.
+//
+// Other observers implement onEvent() for the event types above they are interested in and a template
+// for the rest (all events are sent to every observer). The generator keeps its own copy of the observer,
+// see the observer() accessors of the generators.
+struct NullMazeObserver
+{
+    template< typename Event >
+    void onEvent(const Event&) {}
+};
+
+// Sets the state of a node (or an edge) of the maze and reports it to the observer of a generator
+template< typename Maze, typename Observer >
+void setNodeObserved(Maze& maze, Observer& observer, typename Maze::NodeIndex node, ENode state) {
+    maze.setNode(node, state);
+    observer.onEvent(NodeChangedEvent<typename Maze::NodeIndex>{node, state});
+}
+
+template< typename Maze, typename Observer >
+void setEdgeObserved(Maze& maze, Observer& observer, typename Maze::NodeIndex node, typename Maze::EdgeIndex edge,
+                     EEdge state) {
+    maze.setEdge(node, edge, state);
+    observer.onEvent(EdgeChangedEvent<typename Maze::NodeIndex>{node, static_cast<int>(edge), state});
+}
+
 // Wilson's algorithm
 // https://en.wikipedia.org/wiki/Maze_generation_algorithm#Wilson%27s_algorithm
 //
@@ -39,34 +124,59 @@ enum class ECreateMazeResult
 //  ENode getNode(NodeIndex node) const;
 //  void setNode(NodeIndex node, ENode val);
 //
-//  // Return the list of open edges
-//  void getOpenEdges(NodeIndex node, std::vector<EdgeIndex>& edges) const;
+//  // Return the open (or on path) edges. The grid keeps the masks up to date in setEdge, since this
+//  // is called at every step
+//  EdgeMask getOpenEdgeMask(NodeIndex node) const;
 //
 //  // Set edge status
 //  void setEdge(NodeIndex node, EdgeIndex edge, EEdge val);
 //
-//  // Get an open node (any)
+//  // Get an open node (any). It is called at the start of every random walk, so it must not scan the grid
 //  NodeIndex getOpenNode() const;
 //
 //  // Return the adjacent node of `node` along `edge`. The algorithm will call this function
-//  // only with valid nodes and edges returned by getOpenEdges()
+//  // only with valid nodes and edges returned by getOpenEdgeMask()
 //  static NodeIndex nextNode(NodeIndex node, EdgeIndex edge);
 //
 //  // The invalid value for NodeIndex to indicate errors
 //  static NodeIndex invalidNode();
 //
-template< typename Maze >
+// Type parameter `RandomEngine` is a UniformRandomBitGenerator with 32-bit output that can be constructed
+// from the seed, e.g. Pcg32 (the default) or std::mt19937. Random edges are selected with randomBelow().
+//
+// Type parameter `Observer` receives the changes of the nodes and edges, the start of every walk and the
+// erased loops (see NullMazeObserver).
+//
+// Reproducibility: the maze depends only on the seed, the engine and the grid, not on the platform or the
+// standard library. For the same seed, grid size and start order, the same maze is created everywhere.
+// (The grids list open edges in a fixed order and EOpenNodeOrder::Random is shuffled with Pcg32 too.)
+// Changing the default engine or the way it is used breaks this, mazes generated earlier would change.
+//
+template< typename Maze, typename RandomEngine = Pcg32, typename Observer = NullMazeObserver >
 class CreateMazeWilson
 {
 public:
-    explicit CreateMazeWilson(unsigned random_seed);
+    explicit CreateMazeWilson(unsigned random_seed, Observer observer = Observer());
+
+    // Restarts the random engine with a new seed, so the generator and its buffers are reused for another maze
+    void reseed(unsigned random_seed) { random_engine_ = RandomEngine(random_seed); }
 
     ECreateMazeResult createMaze(Maze& maze);
 
+    // Counters of the last createMaze() call
+    const CreateMazeStats& stats() const { return stats_; }
+
+    Observer& observer() { return observer_; }
+
 private:
     using NodeIndex = Maze::NodeIndex;
     using EdgeIndex = Maze::EdgeIndex;
 
+    void setNode(Maze& maze, NodeIndex node, ENode state) { setNodeObserved(maze, observer_, node, state); }
+    void setEdge(Maze& maze, NodeIndex node, EdgeIndex edge, EEdge state) {
+        setEdgeObserved(maze, observer_, node, edge, state);
+    }
+
     // Represents a single step on a path
     struct PathItem
     {
@@ -80,25 +190,29 @@ private:
     // Find a random step from the given node. Returns false if there are no open edges from `node`
     bool getRandomStep(const Maze& maze, NodeIndex node, PathItem& step);
 
-    // This variable is local to getRandomStep but is a member to avoid reallocating the array on each call
-    std::vector<EdgeIndex> open_edges_;
     // The current random walk
     std::vector<PathItem> current_path_;
 
-    std::mt19937 random_engine_;
+    CreateMazeStats stats_;
+
+    RandomEngine random_engine_;
+    [[no_unique_address]] Observer observer_;
 };
 
-template< typename Maze >
-CreateMazeWilson<Maze>::CreateMazeWilson(unsigned random_seed): random_engine_(random_seed) {}
+template< typename Maze, typename RandomEngine, typename Observer >
+CreateMazeWilson<Maze, RandomEngine, Observer>::CreateMazeWilson(unsigned random_seed, Observer observer)
+    : random_engine_(random_seed)
+    , observer_(std::move(observer)) {}
 
-template< typename Maze >
-ECreateMazeResult CreateMazeWilson<Maze>::createMaze(Maze& maze) {
+template< typename Maze, typename RandomEngine, typename Observer >
+ECreateMazeResult CreateMazeWilson<Maze, RandomEngine, Observer>::createMaze(Maze& maze) {
     // Add a random node to the graph
     const auto first_node = maze.getOpenNode();
     if (first_node == Maze::invalidNode()) {
         return ECreateMazeResult::ErrNoFirstOpenNode;
     }
-    maze.setNode(first_node, ENode::Visited);
+    setNode(maze, first_node, ENode::Visited);
+    stats_ = {};
 
     for (;;) {
         // While there are still open nodes, pick one to start a random path
@@ -106,14 +220,17 @@ ECreateMazeResult CreateMazeWilson<Maze>::createMaze(Maze& maze) {
         if (start_node == Maze::invalidNode()) {
             break;
         }
-        maze.setNode(start_node, ENode::OnPath);
+        setNode(maze, start_node, ENode::OnPath);
+        stats_.wilson_walks++;
+        observer_.onEvent(WalkStartedEvent<NodeIndex>{start_node});
 
         // Pick a random edge and make a step to the next node
         PathItem step;
         if (!getRandomStep(maze, start_node, step)) {
             return ECreateMazeResult::ErrNoOpenEdges;
         }
-        maze.setEdge(start_node, step.edge, EEdge::OnPath);
+        stats_.wilson_steps++;
+        setEdge(maze, start_node, step.edge, EEdge::OnPath);
         current_path_.clear();
         current_path_.emplace_back(step);
 
@@ -129,24 +246,27 @@ ECreateMazeResult CreateMazeWilson<Maze>::createMaze(Maze& maze) {
 
                 // Delete last item
                 assert(!current_path_.empty());
+                const auto path_length = current_path_.size();
                 const auto src_node = current_path_.size() >= 2
                     ? current_path_[current_path_.size() - 2].target_node
                     : start_node;
-                maze.setEdge(src_node, current_path_.back().edge, EEdge::Open);
+                setEdge(maze, src_node, current_path_.back().edge, EEdge::Open);
                 current_path_.pop_back();
 
                 while (!current_path_.empty() && current_path_.back().target_node != last_node) {
-                    maze.setNode(current_path_.back().target_node, ENode::Open);
+                    setNode(maze, current_path_.back().target_node, ENode::Open);
                     const auto src_node = current_path_.size() >= 2
                         ? current_path_[current_path_.size() - 2].target_node
                         : start_node;
-                    maze.setEdge(src_node, current_path_.back().edge, EEdge::Open);
+                    setEdge(maze, src_node, current_path_.back().edge, EEdge::Open);
                     current_path_.pop_back();
                 }
+                observer_.onEvent(LoopErasedEvent<NodeIndex>{last_node,
+                                                             static_cast<int>(path_length - current_path_.size())});
                 last_node = current_path_.empty() ? start_node : current_path_.back().target_node;
 
             } else {
-                maze.setNode(last_node, ENode::OnPath);
+                setNode(maze, last_node, ENode::OnPath);
             }
 
             // Pick a random edge and make a step to the next node
@@ -154,16 +274,17 @@ ECreateMazeResult CreateMazeWilson<Maze>::createMaze(Maze& maze) {
             if (!getRandomStep(maze, last_node, step)) {
                 return ECreateMazeResult::ErrNoOpenEdges;
             }
-            maze.setEdge(last_node, step.edge, EEdge::OnPath);
+            stats_.wilson_steps++;
+            setEdge(maze, last_node, step.edge, EEdge::OnPath);
             current_path_.emplace_back(step);
         }
 
         // Add all nodes of the path to the graph
-        maze.setNode(start_node, ENode::Visited);
+        setNode(maze, start_node, ENode::Visited);
         auto prev_node = start_node;
         for (const auto& step : current_path_) {
-            maze.setEdge(prev_node, step.edge, EEdge::Visited);
-            maze.setNode(step.target_node, ENode::Visited);
+            setEdge(maze, prev_node, step.edge, EEdge::Visited);
+            setNode(maze, step.target_node, ENode::Visited);
             prev_node = step.target_node;
         }
     }
@@ -171,16 +292,15 @@ ECreateMazeResult CreateMazeWilson<Maze>::createMaze(Maze& maze) {
     return ECreateMazeResult::Ok;
 }
 
-template< typename Maze >
-bool CreateMazeWilson<Maze>::getRandomStep(const Maze& maze, NodeIndex node, PathItem& step) {
-    open_edges_.clear();
-    maze.getOpenEdges(node, open_edges_);
-    if (open_edges_.empty()) {
+template< typename Maze, typename RandomEngine, typename Observer >
+bool CreateMazeWilson<Maze, RandomEngine, Observer>::getRandomStep(const Maze& maze, NodeIndex node, PathItem& step) {
+    const auto open_edges = maze.getOpenEdgeMask(node);
+    if (open_edges == 0) {
         return false;
     }
 
-    std::uniform_int_distribution<int> dist(0, open_edges_.size() - 1);
-    const auto edge = open_edges_[dist(random_engine_)];
+    const auto k = randomBelow(random_engine_, static_cast<uint32_t>(std::popcount(open_edges)));
+    const auto edge = static_cast<EdgeIndex>(selectEdge(open_edges, k));
     const auto target_node = maze.nextNode(node, edge);
     step = {edge, target_node};
     return true;
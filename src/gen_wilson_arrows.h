@@ -0,0 +1,156 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "random.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <bit>
+#include <utility>
+#include <vector>
+
+// Wilson's algorithm in the "last exit" formulation
+//
+// The loop-erased random walk from a node to the tree is the path that follows, from each node, the edge
+// the walk left it along for the last time. So instead of keeping the path and erasing the loops as they
+// close, the walk only stores its exit direction (the arrow) for every node it leaves, and a later visit
+// simply overwrites it. When the walk reaches the tree, a single forward pass along the arrows from the
+// start node adds the path to the maze.
+//
+// The grid is not written during the walk at all, and the only per-step write is the arrow, one byte per
+// node. The random walk draws the same random numbers in the same order as CreateMazeWilson, so with the
+// same seed (and RandomEngine) both produce exactly the same maze.
+//
+// The observer (see NullMazeObserver) receives the start of every walk and the changes of the nodes and
+// edges, which are only made by the forward pass. There are no LoopErasedEvents: the loops are never seen.
+//
+// Type parameter `Maze` is expected to implement the interface required by CreateMazeWilson plus:
+//  // Linear node ids (0 <= id < nodeCount())
+//  int nodeCount() const;
+//  int nodeId(NodeIndex node) const;
+//
+template< typename Maze, typename RandomEngine = Pcg32, typename Observer = NullMazeObserver >
+class CreateMazeWilsonArrows
+{
+public:
+    using NodeIndex = Maze::NodeIndex;
+
+    explicit CreateMazeWilsonArrows(unsigned random_seed, Observer observer = Observer());
+
+    // Restarts the random engine with a new seed, so the generator and its buffers are reused for another maze
+    void reseed(unsigned random_seed) { random_engine_ = RandomEngine(random_seed); }
+
+    ECreateMazeResult createMaze(Maze& maze);
+
+    // The parts of createMaze(), for callers running the walks step by step (see createMazeWilsonSteps).
+    // addFirstNode starts a new maze. startWalk picks the start node of the next walk, or returns
+    // Maze::invalidNode() once the maze is complete. walkStep makes a step of the walk from `node` and
+    // returns the next node, or Maze::invalidNode() if there are no open edges. When the walk reaches a
+    // visited node, addPath adds it to the maze.
+    ECreateMazeResult addFirstNode(Maze& maze);
+    NodeIndex startWalk(const Maze& maze);
+    NodeIndex walkStep(const Maze& maze, NodeIndex node);
+    void addPath(Maze& maze, NodeIndex start_node);
+
+    // Counters of the last createMaze() call
+    const CreateMazeStats& stats() const { return stats_; }
+
+    Observer& observer() { return observer_; }
+
+private:
+    using EdgeIndex = Maze::EdgeIndex;
+
+    // Exit edge of each node left by the current walk, indexed by node id. Only the entries of the nodes
+    // on the loop-erased path are read, the others are leftovers of erased loops and earlier walks.
+    // Edge indexes are below 32 (see EdgeMask), so a byte is enough.
+    std::vector<uint8_t> arrows_;
+    CreateMazeStats stats_;
+
+    RandomEngine random_engine_;
+    [[no_unique_address]] Observer observer_;
+};
+
+template< typename Maze, typename RandomEngine, typename Observer >
+CreateMazeWilsonArrows<Maze, RandomEngine, Observer>::CreateMazeWilsonArrows(unsigned random_seed,
+                                                                             Observer observer)
+    : random_engine_(random_seed)
+    , observer_(std::move(observer)) {}
+
+template< typename Maze, typename RandomEngine, typename Observer >
+ECreateMazeResult CreateMazeWilsonArrows<Maze, RandomEngine, Observer>::createMaze(Maze& maze) {
+    const auto result = addFirstNode(maze);
+    if (result != ECreateMazeResult::Ok) {
+        return result;
+    }
+
+    for (;;) {
+        // While there are still open nodes, pick one to start a random walk
+        const auto start_node = startWalk(maze);
+        if (start_node == Maze::invalidNode()) {
+            break;
+        }
+
+        // Walk until the tree is reached, overwriting the arrow of a node at each visit
+        auto node = start_node;
+        do {
+            node = walkStep(maze, node);
+            if (node == Maze::invalidNode()) {
+                return ECreateMazeResult::ErrNoOpenEdges;
+            }
+        } while (maze.getNode(node) != ENode::Visited);
+
+        addPath(maze, start_node);
+    }
+
+    return ECreateMazeResult::Ok;
+}
+
+template< typename Maze, typename RandomEngine, typename Observer >
+ECreateMazeResult CreateMazeWilsonArrows<Maze, RandomEngine, Observer>::addFirstNode(Maze& maze) {
+    // Add a random node to the graph
+    stats_ = {};
+    const auto first_node = maze.getOpenNode();
+    if (first_node == Maze::invalidNode()) {
+        return ECreateMazeResult::ErrNoFirstOpenNode;
+    }
+    setNodeObserved(maze, observer_, first_node, ENode::Visited);
+    arrows_.assign(maze.nodeCount(), 0);
+    return ECreateMazeResult::Ok;
+}
+
+template< typename Maze, typename RandomEngine, typename Observer >
+Maze::NodeIndex CreateMazeWilsonArrows<Maze, RandomEngine, Observer>::startWalk(const Maze& maze) {
+    const auto start_node = maze.getOpenNode();
+    if (start_node != Maze::invalidNode()) {
+        stats_.wilson_walks++;
+        observer_.onEvent(WalkStartedEvent<NodeIndex>{start_node});
+    }
+    return start_node;
+}
+
+template< typename Maze, typename RandomEngine, typename Observer >
+Maze::NodeIndex CreateMazeWilsonArrows<Maze, RandomEngine, Observer>::walkStep(const Maze& maze, NodeIndex node) {
+    const auto open_edges = maze.getOpenEdgeMask(node);
+    if (open_edges == 0) {
+        return Maze::invalidNode();
+    }
+    const auto k = randomBelow(random_engine_, static_cast<uint32_t>(std::popcount(open_edges)));
+    const auto edge = static_cast<EdgeIndex>(selectEdge(open_edges, k));
+    arrows_[maze.nodeId(node)] = static_cast<uint8_t>(edge);
+    stats_.wilson_steps++;
+    return maze.nextNode(node, edge);
+}
+
+template< typename Maze, typename RandomEngine, typename Observer >
+void CreateMazeWilsonArrows<Maze, RandomEngine, Observer>::addPath(Maze& maze, NodeIndex start_node) {
+    // Add the loop-erased path to the graph
+    auto node = start_node;
+    while (maze.getNode(node) != ENode::Visited) {
+        const auto edge = static_cast<EdgeIndex>(arrows_[maze.nodeId(node)]);
+        assert(edge != 0);
+        setNodeObserved(maze, observer_, node, ENode::Visited);
+        setEdgeObserved(maze, observer_, node, edge, EEdge::Visited);
+        node = maze.nextNode(node, edge);
+    }
+}
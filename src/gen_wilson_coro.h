@@ -0,0 +1,136 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "gen_wilson_arrows.h"
+#include "random.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <coroutine>
+#include <utility>
+
+// A maze generation running as a coroutine (see createMazeWilsonSteps)
+//
+// The generation starts suspended and runs up to its next yield point at every resume(), so a single
+// thread can interleave it with other work or with other generations, or abandon it (the destructor frees
+// the coroutine frame). progress() returns the counters at the last yield point, or the final ones.
+//
+// A moved-from task is empty (see valid()): it is done, without progress, and it cannot be resumed.
+class MazeGenerationTask
+{
+public:
+    struct promise_type
+    {
+        CreateMazeStats progress;
+        ECreateMazeResult result = ECreateMazeResult::Ok;
+
+        MazeGenerationTask get_return_object() {
+            return MazeGenerationTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const CreateMazeStats& stats) {
+            progress = stats;
+            return {};
+        }
+        // The result and the final counters
+        void return_value(std::pair<ECreateMazeResult, CreateMazeStats> value) {
+            result = value.first;
+            progress = value.second;
+        }
+        // The generators do not throw
+        void unhandled_exception() { abort(); }
+    };
+
+    MazeGenerationTask(MazeGenerationTask&& other) noexcept: handle_(std::exchange(other.handle_, {})) {}
+    MazeGenerationTask& operator=(MazeGenerationTask&& other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+    MazeGenerationTask(const MazeGenerationTask&) = delete;
+    MazeGenerationTask& operator=(const MazeGenerationTask&) = delete;
+
+    ~MazeGenerationTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    // Whether the task has a generation, false after it was moved from
+    bool valid() const { return static_cast<bool>(handle_); }
+
+    // Runs the generation up to the next yield point. Returns false if it has finished, see result().
+    bool resume() {
+        if (done()) {
+            return false;
+        }
+        handle_.resume();
+        return !handle_.done();
+    }
+
+    bool done() const { return !handle_ || handle_.done(); }
+    const CreateMazeStats& progress() const {
+        static const CreateMazeStats NO_PROGRESS;
+        return handle_ ? handle_.promise().progress : NO_PROGRESS;
+    }
+    // The result of the generation once it has finished. The task must be valid.
+    ECreateMazeResult result() const {
+        assert(valid() && handle_.done());
+        return handle_ ? handle_.promise().result : ECreateMazeResult::ErrNoFirstOpenNode;
+    }
+
+private:
+    explicit MazeGenerationTask(std::coroutine_handle<promise_type> handle): handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Wilson's algorithm as a coroutine: it yields its counters every `yield_steps` steps of the random walks,
+// or after each walk if `yield_steps` is 0. All of its state (a CreateMazeWilsonArrows running the walks
+// step by step) is kept in the coroutine frame, `maze` must outlive the returned task.
+//
+// The walks are done in the last exit formulation (see CreateMazeWilsonArrows), so the maze is the same as
+// the one CreateMazeWilson creates with the same seed. It is only written when a walk reaches the tree:
+// a yield in the middle of a walk leaves the grid as it was at the end of the previous walk. The changes
+// are reported to `observer` like the ones of CreateMazeWilsonArrows.
+//
+// Type parameter `Maze` is expected to implement the interface required by CreateMazeWilsonArrows.
+//
+template< typename Maze, typename RandomEngine = Pcg32, typename Observer = NullMazeObserver >
+MazeGenerationTask createMazeWilsonSteps(Maze& maze, unsigned random_seed, long long yield_steps,
+                                         Observer observer = Observer()) {
+    CreateMazeWilsonArrows<Maze, RandomEngine, Observer> maze_gen(random_seed, std::move(observer));
+    auto next_yield = yield_steps;
+
+    const auto result = maze_gen.addFirstNode(maze);
+    if (result != ECreateMazeResult::Ok) {
+        co_return {result, maze_gen.stats()};
+    }
+
+    for (;;) {
+        const auto start_node = maze_gen.startWalk(maze);
+        if (start_node == Maze::invalidNode()) {
+            break;
+        }
+
+        auto node = start_node;
+        do {
+            node = maze_gen.walkStep(maze, node);
+            if (node == Maze::invalidNode()) {
+                co_return {ECreateMazeResult::ErrNoOpenEdges, maze_gen.stats()};
+            }
+            if (maze_gen.stats().wilson_steps == next_yield) {
+                next_yield += yield_steps;
+                co_yield maze_gen.stats();
+            }
+        } while (maze.getNode(node) != ENode::Visited);
+
+        maze_gen.addPath(maze, start_node);
+        if (yield_steps == 0) {
+            co_yield maze_gen.stats();
+        }
+    }
+
+    co_return {ECreateMazeResult::Ok, maze_gen.stats()};
+}
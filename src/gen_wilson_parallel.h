@@ -0,0 +1,256 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "random.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Wilson's algorithm with concurrent loop-erased random walks
+//
+// Every node has an arrow (the edge a walk leaves it along). A walk follows the arrows and draws a new
+// random arrow for a node only when it has none. A cycle found along the way is erased by dropping the
+// arrows of its nodes ("cycle popping"). Wilson showed that the resulting tree does not depend on the
+// order in which cycles are popped, so walks running at the same time produce the same uniform
+// distribution as the sequential CreateMazeWilson.
+//
+// Walks claim the nodes on their path by an atomic compare-and-swap on the node state. When a walk reaches
+// a node claimed by another walk:
+//  - if the other walk has a smaller id it has priority: this walk releases its claims and starts again.
+//    The arrows of the released nodes are kept, they are not popped, so the restarted walk (or any other
+//    one) follows them again. No randomness is thrown away, which is what keeps the result uniform.
+//  - otherwise this walk waits until the node is released. Walks only wait for walks with a greater id,
+//    so there is no deadlock.
+//
+// Unlike CreateMazeWilson, the maze is not reproducible with more than one thread: which walk draws the
+// arrow of a node depends on the timing of the threads.
+//
+// The grid is only read while the walks are running (getOpenEdgeMask and nextNode must be thread-safe for
+// reading). The tree is written to the grid in a single pass at the end.
+//
+// Type parameter `Maze` is expected to implement the interface required by CreateMazeWilson plus:
+//  // Linear node ids (0 <= id < nodeCount())
+//  int nodeCount() const;
+//  int nodeId(NodeIndex node) const;
+//  NodeIndex nodeFromId(int id) const;
+//
+template< typename Maze >
+class CreateMazeWilsonParallel
+{
+public:
+    CreateMazeWilsonParallel(unsigned random_seed, int num_threads);
+
+    // Sets the seed of the next createMaze() call, so the generator and its buffers are reused for another maze
+    void reseed(unsigned random_seed) { random_seed_ = random_seed; }
+
+    int numThreads() const { return num_threads_; }
+
+    ECreateMazeResult createMaze(Maze& maze);
+
+    // Counters of the last createMaze() call. Restarted walks are counted again.
+    const CreateMazeStats& stats() const { return stats_; }
+
+private:
+    using NodeIndex = Maze::NodeIndex;
+    using EdgeIndex = Maze::EdgeIndex;
+
+    // Node states, any other value is the id of the walk claiming the node
+    static constexpr int32_t STATE_FREE = -1;   // Open node not on any path
+    static constexpr int32_t STATE_TREE = -2;   // Node already in the maze (or not part of it at all)
+
+    static constexpr EdgeIndex NO_ARROW = 0;    // Valid edge indexes start from 1 in all grids
+
+    enum class EWalkResult
+    {
+        Done,       // The start node is in the tree
+        Restart,    // Gave way to a walk with higher priority
+        Error,      // Reached a node without open edges
+    };
+
+    void runWorker(const Maze& maze, int walk_id);
+    EWalkResult walk(const Maze& maze, int walk_id, int start, Pcg32& random_engine,
+                     std::vector<int>& path, long long& steps);
+    void release(const std::vector<int>& path);
+
+    unsigned random_seed_;
+    int num_threads_;
+
+    std::unique_ptr<std::atomic<int32_t>[]> state_;
+    // Size of state_, it is only reallocated for a larger grid
+    int state_size_ = 0;
+    // arrows_[id] is only accessed by the walk that claimed node `id`
+    std::vector<EdgeIndex> arrows_;
+    std::atomic<int> next_start_;
+    std::atomic<bool> failed_;
+    // Summed up from the workers when they finish
+    std::atomic<long long> steps_;
+    std::atomic<int> walks_;
+    CreateMazeStats stats_;
+};
+
+template< typename Maze >
+CreateMazeWilsonParallel<Maze>::CreateMazeWilsonParallel(unsigned random_seed, int num_threads)
+    : random_seed_(random_seed)
+    , num_threads_(num_threads)
+{
+    assert(num_threads > 0);
+}
+
+template< typename Maze >
+ECreateMazeResult CreateMazeWilsonParallel<Maze>::createMaze(Maze& maze) {
+    // Add a node to the graph, just like the sequential version
+    const auto first_node = maze.getOpenNode();
+    if (first_node == Maze::invalidNode()) {
+        return ECreateMazeResult::ErrNoFirstOpenNode;
+    }
+    maze.setNode(first_node, ENode::Visited);
+
+    const auto node_count = maze.nodeCount();
+    if (state_size_ < node_count) {
+        state_.reset(new std::atomic<int32_t>[node_count]);
+        state_size_ = node_count;
+    }
+    arrows_.assign(node_count, NO_ARROW);
+    for (int id = 0; id < node_count; id++) {
+        const auto open = maze.getNode(maze.nodeFromId(id)) == ENode::Open;
+        state_[id].store(open ? STATE_FREE : STATE_TREE, std::memory_order_relaxed);
+    }
+    next_start_ = 0;
+    failed_ = false;
+    steps_ = 0;
+    walks_ = 0;
+
+    std::vector<std::thread> threads;
+    for (int walk_id = 1; walk_id < num_threads_; walk_id++) {
+        threads.emplace_back([this, &maze, walk_id]{ runWorker(maze, walk_id); });
+    }
+    runWorker(maze, 0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stats_ = {};
+    stats_.wilson_steps = steps_;
+    stats_.wilson_walks = walks_;
+
+    if (failed_) {
+        return ECreateMazeResult::ErrNoOpenEdges;
+    }
+
+    // Add all new nodes and their arrows to the graph
+    for (int id = 0; id < node_count; id++) {
+        if (arrows_[id] == NO_ARROW) {
+            continue;
+        }
+        const auto node = maze.nodeFromId(id);
+        maze.setEdge(node, arrows_[id], EEdge::Visited);
+        maze.setNode(node, ENode::Visited);
+    }
+
+    return ECreateMazeResult::Ok;
+}
+
+template< typename Maze >
+void CreateMazeWilsonParallel<Maze>::runWorker(const Maze& maze, int walk_id) {
+    // Each walk has its own stream
+    Pcg32 random_engine(random_seed_, walk_id);
+    std::vector<int> path;
+    auto steps = 0LL;
+    auto walks = 0;
+
+    const auto node_count = static_cast<int>(arrows_.size());
+    for (;;) {
+        // Start nodes are handed out in scan order, each one is walked until it is in the tree
+        const auto start = next_start_.fetch_add(1, std::memory_order_relaxed);
+        if (start >= node_count || failed_.load(std::memory_order_relaxed)) {
+            break;
+        }
+        for (;;) {
+            if (failed_.load(std::memory_order_relaxed)) {
+                break;
+            }
+            walks++;
+            const auto result = walk(maze, walk_id, start, random_engine, path, steps);
+            if (result == EWalkResult::Done) {
+                break;
+            }
+            if (result == EWalkResult::Error) {
+                failed_ = true;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    steps_ += steps;
+    walks_ += walks;
+}
+
+template< typename Maze >
+CreateMazeWilsonParallel<Maze>::EWalkResult CreateMazeWilsonParallel<Maze>::walk(
+        const Maze& maze, int walk_id, int start, Pcg32& random_engine,
+        std::vector<int>& path, long long& steps) {
+    path.clear();
+    auto next = start;
+    auto next_node = maze.nodeFromId(start);
+    for (;;) {
+        auto state = state_[next].load(std::memory_order_acquire);
+        if (state == STATE_TREE) {
+            // The path is finished, add it to the tree
+            for (const auto id : path) {
+                state_[id].store(STATE_TREE, std::memory_order_release);
+            }
+            return EWalkResult::Done;
+        }
+
+        if (state == walk_id) {
+            // Found a loop, pop it. The arrow of `next` is popped too, it is the first node of the loop.
+            while (path.back() != next) {
+                arrows_[path.back()] = NO_ARROW;
+                state_[path.back()].store(STATE_FREE, std::memory_order_release);
+                path.pop_back();
+            }
+            arrows_[next] = NO_ARROW;
+        } else if (state == STATE_FREE) {
+            if (!state_[next].compare_exchange_weak(state, walk_id, std::memory_order_acq_rel)) {
+                continue;
+            }
+            path.push_back(next);
+        } else if (state < walk_id) {
+            // Claimed by a walk with higher priority
+            release(path);
+            return EWalkResult::Restart;
+        } else {
+            // Claimed by a walk with lower priority, wait until it is released
+            std::this_thread::yield();
+            continue;
+        }
+
+        // `next` is the last node of the path now. Follow its arrow, draw a new one if needed
+        auto& arrow = arrows_[next];
+        if (arrow == NO_ARROW) {
+            const auto open_edges = maze.getOpenEdgeMask(next_node);
+            if (open_edges == 0) {
+                release(path);
+                return EWalkResult::Error;
+            }
+            const auto k = randomBelow(random_engine, static_cast<uint32_t>(std::popcount(open_edges)));
+            arrow = static_cast<EdgeIndex>(selectEdge(open_edges, k));
+        }
+        steps++;
+        next_node = maze.nextNode(next_node, arrow);
+        next = maze.nodeId(next_node);
+    }
+}
+
+template< typename Maze >
+void CreateMazeWilsonParallel<Maze>::release(const std::vector<int>& path) {
+    // The arrows are kept, the next walk reaching these nodes has to follow them
+    for (const auto id : path) {
+        state_[id].store(STATE_FREE, std::memory_order_release);
+    }
+}
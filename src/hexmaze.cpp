@@ -1,6 +1,16 @@
 #include "hexmaze.h"
+#include "create_maze.h"
+#include "gen_region.h"
+#include "grid_topology.h"
+#include "maze_journal.h"
+#include "maze_solver.h"
 #include "painter.h"
 
+#include <math.h>
+
+#include <algorithm>
+#include <bit>
+
 using namespace std;
 
 using EStyle = IPainter::EStyle;
@@ -15,12 +25,32 @@ static constexpr char EDGE_VISITED = 1;
 static constexpr char EDGE_ONPATH = 2;
 static constexpr char EDGE_INVALID = 3; // Edge that cannot be visited
 
-#define E1(i, j)    (edges_[i+1][3*j + 3])                                      // direction SW
-#define E2(i, j)    (edges_[i+1][3*j + 4])                                      // direction S
-#define E3(i, j)    (edges_[i+1][3*j + 5])                                      // direction SE
-#define E4(i, j)    ((j % 2) == 0 ? edges_[i][3*j + 6] : edges_[i+1][3*j + 6])  // direction NE
-#define E5(i, j)    (edges_[i][3*j + 4])                                        // direction N
-#define E6(i, j)    ((j % 2) == 0 ? edges_[i][3*j + 2] : edges_[i+1][3*j + 2])  // direction NW
+// Edge slots and neighbours of HexMaze. Edge directions: 1 SW, 2 S, 3 SE, 4 NE, 5 N, 6 NW
+static constexpr GridTopology<6, 2> TOPOLOGY = {
+    EGridParity::Column,
+    3,
+    {
+        {{0, 0}, {1, 3}, {1, 4}, {1, 5}, {0, 6}, {0, 4}, {0, 2}},           // Even columns
+        {{0, 0}, {1, 3}, {1, 4}, {1, 5}, {1, 6}, {0, 4}, {1, 2}},           // Odd columns
+    },
+    {
+        {{0, 0}, {0, -1}, {1, 0}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}},      // Even columns
+        {{0, 0}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 0}, {0, -1}},        // Odd columns
+    },
+};
+static_assert(TOPOLOGY.isConsistent());
+
+inline int HexMaze::edgeState(int i, int j, EdgeIndex edge) const {
+    const auto slot = TOPOLOGY.edgeSlot(i, j, edge);
+    return edges_[slot.row][slot.col];
+}
+
+void HexMaze::setEdgeState(int i, int j, EdgeIndex edge, int state) {
+    const auto slot = TOPOLOGY.edgeSlot(i, j, edge);
+    auto state_ref = edges_[slot.row][slot.col];
+    open_edge_masks_.update(TOPOLOGY, i, j, edge, state_ref, state);
+    state_ref = state;
+}
 
 struct PointParams
 {
@@ -41,10 +71,22 @@ HexMaze::HexMaze(int rows, int cols)
     , cols_(cols)
     , nodes_(rows, cols)
     , edges_(rows+1, 3*(cols+2))
+    , open_nodes_(rows*cols)
+    , open_edge_masks_(rows, cols)
 {
     invalidateRegionEdges({0, 0}, {rows-1, cols-1});
 }
 
+HexMaze::~HexMaze() = default;
+
+void HexMaze::Reset() {
+    nodes_.clear();
+    edges_.clear();
+    open_nodes_.reset();
+    open_edge_masks_.reset();
+    invalidateRegionEdges({0, 0}, {rows_-1, cols_-1});
+}
+
 inline static bool isEdgeVisible(char edge) {
     return edge == EDGE_OPEN || edge == EDGE_INVALID;
 }
@@ -91,6 +133,10 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
     // Cells
     for (int i = 0; i < rows_; i++) {
         for (int j = 0; j < cols_; j++) {
+            const auto style = nodeStyle(nodes_[i][j]);
+            if (!p.isCellDrawn(style)) {
+                continue;
+            }
             const auto c = nodeCenter({i, j}, rad, h, padding_x, padding_y);
             const auto p = PointParams{c, rad, h};
             const auto p1{P1(p)};
@@ -100,7 +146,7 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p5{P5(p)};
             const auto p6{P6(p)};
 
-            painter.DrawPoly({p5, p4, p3, p2, p1, p6}, nodeStyle(nodes_[i][j]));
+            painter.DrawPoly({p5, p4, p3, p2, p1, p6}, style);
         }
     }
 
@@ -112,7 +158,7 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p1{P1(p)};
         const auto p6{P6(p)};
 
-        const char e6 = E6(i, j);
+        const char e6 = edgeState(i, j, 6);
         if (isEdgeVisible(e6)) {
             painter.DrawLine(p6, p1, edgeStyle(e6));
         }
@@ -127,7 +173,7 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p4{P4(p)};
         const auto p5{P5(p)};
 
-        const char e4 = E4(i, j);
+        const char e4 = edgeState(i, j, 4);
         if (isEdgeVisible(e4)) {
             painter.DrawLine(p4, p5, edgeStyle(e4));
         }
@@ -143,9 +189,9 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p5{P5(p)};
         const auto p6{P6(p)};
 
-        const char e4 = E4(i, j);
-        const char e5 = E5(i, j);
-        const char e6 = E6(i, j);
+        const char e4 = edgeState(i, j, 4);
+        const char e5 = edgeState(i, j, 5);
+        const char e6 = edgeState(i, j, 6);
         if (isEdgeVisible(e4)) {
             painter.DrawLine(p4, p5, edgeStyle(e4));
         }
@@ -165,7 +211,7 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p5{P5(p)};
         const auto p6{P6(p)};
 
-        const char e5 = E5(i, j);
+        const char e5 = edgeState(i, j, 5);
         if (isEdgeVisible(e5)) {
             painter.DrawLine(p5, p6, edgeStyle(e5));
         }
@@ -185,9 +231,9 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p3{P3(p)};
             const auto p4{P4(p)};
 
-            const char e1 = E1(i, j);
-            const char e2 = E2(i, j);
-            const char e3 = E3(i, j);
+            const char e1 = edgeState(i, j, 1);
+            const char e2 = edgeState(i, j, 2);
+            const char e3 = edgeState(i, j, 3);
             if (isEdgeVisible(e1)) {
                 painter.DrawLine(p1, p2, edgeStyle(e1));
             }
@@ -225,9 +271,9 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p3{P3(p)};
             const auto p4{P4(p)};
 
-            const char e1 = E1(i, j);
-            const char e2 = E2(i, j);
-            const char e3 = E3(i, j);
+            const char e1 = edgeState(i, j, 1);
+            const char e2 = edgeState(i, j, 2);
+            const char e3 = edgeState(i, j, 3);
             if (b1 && isEdgeVisible(e1)) {
                 painter.DrawLine(p1, p2, edgeStyle(e1));
             }
@@ -240,6 +286,18 @@ void HexMaze::Draw(IPainter& painter, const DrawParams& p) const {
         }
     }
 
+    // Solution
+    if (p.show_solution) {
+        MazeSolver<HexMaze> solver;
+        vector<NodeIndex> path;
+        if (solver.solve(*this, path)) {
+            for (size_t k = 1; k < path.size(); k++) {
+                painter.DrawLine(nodeCenter(path[k - 1], rad, h, padding_x, padding_y),
+                                 nodeCenter(path[k], rad, h, padding_x, padding_y), EStyle::Solution);
+            }
+        }
+    }
+
     painter.EndDraw();
 }
 
@@ -248,6 +306,7 @@ static ENode toNode(char c) {
         case NODE_OPEN: return ENode::Open;
         case NODE_VISITED: return ENode::Visited;
         case NODE_ONPATH: return ENode::OnPath;
+        case NODE_INVALID: return ENode::Invalid;
         default:
             assert(0);
     }
@@ -258,6 +317,7 @@ static char fromNode(ENode node) {
         case ENode::Open: return NODE_OPEN;
         case ENode::Visited: return NODE_VISITED;
         case ENode::OnPath: return NODE_ONPATH;
+        case ENode::Invalid: return NODE_INVALID;
         default:
             assert(0);
     }
@@ -269,29 +329,18 @@ ENode HexMaze::getNode(NodeIndex node) const {
 
 void HexMaze::setNode(NodeIndex node, ENode val) {
     nodes_[node.i][node.j] = fromNode(val);
-
-    if (on_change_hook_) {
-        on_change_hook_();
+    if (val == ENode::Open) {
+        open_nodes_.insert(nodeId(node));
+    } else {
+        open_nodes_.erase(nodeId(node));
     }
 }
 
 void HexMaze::getOpenEdges(NodeIndex node, vector<EdgeIndex>& edges) const {
-    const auto i = node.i;
-    const auto j = node.j;
-    const char e1 = E1(i, j);
-    const char e2 = E2(i, j);
-    const char e3 = E3(i, j);
-    const char e4 = E4(i, j);
-    const char e5 = E5(i, j);
-    const char e6 = E6(i, j);
-
     edges.clear();
-    if (e1 == EDGE_OPEN || e1 == EDGE_ONPATH) edges.push_back(1);
-    if (e2 == EDGE_OPEN || e2 == EDGE_ONPATH) edges.push_back(2);
-    if (e3 == EDGE_OPEN || e3 == EDGE_ONPATH) edges.push_back(3);
-    if (e4 == EDGE_OPEN || e4 == EDGE_ONPATH) edges.push_back(4);
-    if (e5 == EDGE_OPEN || e5 == EDGE_ONPATH) edges.push_back(5);
-    if (e6 == EDGE_OPEN || e6 == EDGE_ONPATH) edges.push_back(6);
+    for (auto mask = getOpenEdgeMask(node); mask != 0; mask &= mask - 1) {
+        edges.push_back(std::countr_zero(mask));
+    }
 }
 
 static char fromEdge(EEdge edge) {
@@ -299,57 +348,34 @@ static char fromEdge(EEdge edge) {
         case EEdge::Open: return EDGE_OPEN;
         case EEdge::Visited: return EDGE_VISITED;
         case EEdge::OnPath: return EDGE_ONPATH;
-        default:
-            assert(0);
+        case EEdge::Invalid: return EDGE_INVALID;
     }
+    assert(0);
+    return EDGE_INVALID;
 }
 
 void HexMaze::setEdge(NodeIndex node, EdgeIndex edge, EEdge val) {
     const auto i = node.i;
     const auto j = node.j;
     const auto c = fromEdge(val);
-    switch (edge) {
-        case 1: E1(i, j) = c; break;
-        case 2: E2(i, j) = c; break;
-        case 3: E3(i, j) = c; break;
-        case 4: E4(i, j) = c; break;
-        case 5: E5(i, j) = c; break;
-        case 6: E6(i, j) = c; break;
-        default:
-            assert(0);
-    }
-
-    if (on_change_hook_) {
-        on_change_hook_();
-    }
+    assert(1 <= edge && edge <= 6);
+    setEdgeState(i, j, edge, c);
 }
 
 EEdge HexMaze::getEdge(NodeIndex node, EdgeIndex edge) const {
     const auto i = node.i;
     const auto j = node.j;
-    int intval = 0;
-    switch (edge) {
-        case 1: intval = E1(i, j); break;
-        case 2: intval = E2(i, j); break;
-        case 3: intval = E3(i, j); break;
-        case 4: intval = E4(i, j); break;
-        case 5: intval = E5(i, j); break;
-        case 6: intval = E6(i, j); break;
-        default:
-            assert(0);
-    }
+    assert(1 <= edge && edge <= 6);
+    const auto intval = edgeState(i, j, edge);
     return static_cast<EEdge>(intval);
 }
 
 HexMaze::NodeIndex HexMaze::getOpenNode() const {
-    for (int i = 0; i < nodes_.rows(); i++) {
-        for (int j = 0; j < nodes_.cols(); j++) {
-            if (nodes_[i][j] == NODE_OPEN) {
-                return {i, j};
-            }
-        }
+    const auto id = open_nodes_.first();
+    if (id < 0) {
+        return invalidNode();
     }
-    return invalidNode();
+    return nodeFromId(id);
 }
 
 bool HexMaze::nodeExists(NodeIndex node) const {
@@ -358,33 +384,10 @@ bool HexMaze::nodeExists(NodeIndex node) const {
 }
 
 HexMaze::NodeIndex HexMaze::nextNode(NodeIndex node, EdgeIndex edge) {
-    const auto i = node.i;
-    const auto j = node.j;
-    switch (edge) {
-        case 1:
-            if ((j % 2) == 0)
-                return {i, j-1};
-            else
-                return {i+1, j-1};
-        case 2: return {i+1, j};
-        case 3:
-            if ((j % 2) == 0)
-                return {i, j+1};
-            else
-                return {i+1, j+1};
-        case 4:
-            if ((j % 2) == 0)
-                return {i-1, j+1};
-            else
-                return {i, j+1};
-        case 5: return {i-1, j};
-        case 6:
-            if ((j % 2) == 0)
-                return {i-1, j-1};
-            else
-                return {i, j-1};
+    if (edge < 1 || edge > 6) {
+        return invalidNode();
     }
-    return invalidNode();
+    return TOPOLOGY.nextNode(node.i, node.j, edge);
 }
 
 HexMaze::NodeIndex HexMaze::invalidNode() {
@@ -399,14 +402,14 @@ void HexMaze::invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight) {
         {
             // Left vertical line
             const auto j = topLeft.j;
-            E1(i, j) = EDGE_INVALID;
-            E6(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 1, EDGE_INVALID);
+            setEdgeState(i, j, 6, EDGE_INVALID);
         }
         {
             // Right vertical line
             const auto j = bottomRight.j;
-            E3(i, j) = EDGE_INVALID;
-            E4(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 3, EDGE_INVALID);
+            setEdgeState(i, j, 4, EDGE_INVALID);
         }
     }
 
@@ -415,22 +418,22 @@ void HexMaze::invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight) {
             // Top horizontal line
             const auto i = topLeft.i;
             if ((j % 2) == 0) {
-                E4(i, j) = EDGE_INVALID;
-                E5(i, j) = EDGE_INVALID;
-                E6(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 4, EDGE_INVALID);
+                setEdgeState(i, j, 5, EDGE_INVALID);
+                setEdgeState(i, j, 6, EDGE_INVALID);
             } else {
-                E5(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 5, EDGE_INVALID);
             }
         }
         {
             // Bottom horizontal line
             const auto i = bottomRight.i;
             if ((j % 2) == 0) {
-                E2(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 2, EDGE_INVALID);
             } else {
-                E1(i, j) = EDGE_INVALID;
-                E2(i, j) = EDGE_INVALID;
-                E3(i, j) = EDGE_INVALID;
+                setEdgeState(i, j, 1, EDGE_INVALID);
+                setEdgeState(i, j, 2, EDGE_INVALID);
+                setEdgeState(i, j, 3, EDGE_INVALID);
             }
         }
     }
@@ -442,14 +445,11 @@ void HexMaze::invalidateRegion(NodeIndex topLeft, NodeIndex bottomRight) {
     for (int i = topLeft.i; i <= bottomRight.i; i++) {
         for (int j = topLeft.j; j <= bottomRight.j; j++) {
             nodes_[i][j] = NODE_INVALID;
+            open_nodes_.erase(nodeId({i, j}));
         }
     }
 }
 
-void HexMaze::setOnChangeHook(OnChangeHook&& on_change_hook) {
-    on_change_hook_ = std::move(on_change_hook);
-}
-
 std::tuple<int, int> HexMaze::ComputeGridSize(int area_width, int area_height,
                                               int cell_width, int stroke_width) {
     const auto rad = cell_width / 2;
@@ -466,7 +466,45 @@ void HexMaze::AddExits() {
     setEdge({rows_ - 1, cols_ - 1}, 3, EEdge::Visited);
 }
 
-ECreateMazeResult HexMaze::CreateMaze(unsigned random_seed) {
-    CreateMazeWilson<HexMaze> maze_gen(random_seed);
-    return maze_gen.createMaze(*this);
+void HexMaze::AddLongestPathExits() {
+    addLongestPathExits(*this);
+}
+
+void HexMaze::RecordLongestPathExits(MazeJournal& journal) {
+    addLongestPathExits(*this, JournalRecorder<HexMaze>(journal, *this));
+}
+
+void HexMaze::SetOpenNodeOrder(EOpenNodeOrder order, unsigned random_seed) {
+    open_nodes_.setOrder(order, random_seed);
+}
+
+ECreateMazeResult HexMaze::CreateMaze(const CreateMazeParams& params, CreateMazeStats* stats) {
+    if (!generators_) {
+        generators_ = std::make_unique<MazeGenerators<HexMaze>>();
+    }
+    return generators_->createMaze(*this, params, stats);
+}
+
+ECreateMazeResult HexMaze::RecordMaze(const CreateMazeParams& params, CreateMazeStats* stats,
+                                      MazeJournal& journal) {
+    return createMaze(*this, params, stats, JournalRecorder<HexMaze>(journal, *this));
+}
+
+void HexMaze::DrawAnimation(IPainter& painter, const DrawParams& p, const MazeJournal& journal,
+                            int frame_count) {
+    drawJournalFrames(*this, journal, frame_count, painter, p);
+}
+
+void HexMaze::RegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                               CreateMazeStats* stats) {
+    regenerateRegion(*this, top_left, bottom_right, random_seed, stats);
+}
+
+void HexMaze::RecordRegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                                     CreateMazeStats* stats, MazeJournal& journal) {
+    regenerateRegion(*this, top_left, bottom_right, random_seed, stats, JournalRecorder<HexMaze>(journal, *this));
+}
+
+MazeMetrics HexMaze::ComputeMetrics() const {
+    return computeMazeMetrics(*this);
 }
@@ -1,9 +1,17 @@
 #pragma once
 
+#include "grid_topology.h"
 #include "matrix.h"
+#include "open_node_index.h"
 #include "node_index_2d.h"
 #include "maze_grid.h"
 
+#include <stdint.h>
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
 struct IPainter;
 struct DrawParams;
 
@@ -15,13 +23,18 @@ public:
     using EdgeIndex = int;
     using EdgeList = std::vector<HexMaze::EdgeIndex>;
 
+    // Edges are numbered from 1 to EDGE_COUNT
+    static constexpr int EDGE_COUNT = 6;
+
     HexMaze(int rows, int cols);
+    ~HexMaze() override;
 
     //--------------------------------------------------
     // Interface for CreateMazeWilson
     ENode getNode(NodeIndex node) const;
     void setNode(NodeIndex node, ENode val);
 
+    EdgeMask getOpenEdgeMask(NodeIndex node) const { return open_edge_masks_.get(node); }
     void getOpenEdges(NodeIndex node, std::vector<EdgeIndex>& edges) const;
     void setEdge(NodeIndex node, EdgeIndex edge, EEdge val);
     EEdge getEdge(NodeIndex node, EdgeIndex edge) const;
@@ -41,26 +54,48 @@ public:
     //--------------------------------------------------
     // IMazeGrid
     void AddExits() override;
-    ECreateMazeResult CreateMaze(unsigned random_seed) override;
+    void AddLongestPathExits() override;
+    void RecordLongestPathExits(MazeJournal& journal) override;
+    void Reset() override;
+    MazeMetrics ComputeMetrics() const override;
+    ECreateMazeResult CreateMaze(const CreateMazeParams& params, CreateMazeStats* stats) override;
+    ECreateMazeResult RecordMaze(const CreateMazeParams& params, CreateMazeStats* stats,
+                                 MazeJournal& journal) override;
+    void RegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                          CreateMazeStats* stats) override;
+    void RecordRegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                                CreateMazeStats* stats, MazeJournal& journal) override;
     void Draw(IPainter& painter, const DrawParams& p) const override;
+    void DrawAnimation(IPainter& painter, const DrawParams& p, const MazeJournal& journal,
+                       int frame_count) override;
+    void SetOpenNodeOrder(EOpenNodeOrder order, unsigned random_seed) override;
     //--------------------------------------------------
 
     void invalidateRegion(NodeIndex topLeft, NodeIndex bottomRight);
 
-    using OnChangeHook = std::function<void ()>;
-    void setOnChangeHook(OnChangeHook&& on_change_hook);
+    // Linear node ids (0 <= id < nodeCount()) in row-major order
+    int nodeCount() const { return rows_ * cols_; }
+    int nodeId(NodeIndex node) const { return node.i * cols_ + node.j; }
+    NodeIndex nodeFromId(int id) const { return {id / cols_, id % cols_}; }
 
     int rows() const { return rows_; }
     int cols() const { return cols_; }
 
 private:
+    // State of `edge` of node (i, j) in edges_ (see TOPOLOGY in the .cpp file). The state must be set
+    // through setEdgeState to keep the open edge masks of both nodes up to date.
+    int edgeState(int i, int j, EdgeIndex edge) const;
+    void setEdgeState(int i, int j, EdgeIndex edge, int state);
+
     void invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight);
     bool nodeExists(NodeIndex node) const;
 
     int rows_;
     int cols_;
-    Matrix<char> nodes_;
-    Matrix<char> edges_; // Each entry represents an edge in the dual graph (a wall in the maze)
-
-    OnChangeHook on_change_hook_;
+    PackedMatrix<2> nodes_;
+    PackedMatrix<2> edges_; // Each entry represents an edge in the dual graph (a wall in the maze)
+    OpenNodeIndex open_nodes_; // Nodes in ENode::Open state, kept up to date by setNode
+    OpenEdgeMasks<EDGE_COUNT> open_edge_masks_; // Open (or on path) edges of each node, see getOpenEdgeMask
+    // Generators of CreateMaze, kept for the next mazes of the grid (see MazeGenerators)
+    std::unique_ptr<MazeGenerators<HexMaze>> generators_;
 };
@@ -2,16 +2,28 @@
 #include "brick_maze.h"
 #include "hexmaze.h"
 #include "square_maze.h"
+#include "square_maze_stream.h"
 #include "svg_painter.h"
+#include "animated_svg_painter.h"
 #include "maze_grid.h"
+#include "maze_journal.h"
+#include "polyline_painter.h"
+#include "png_painter.h"
 
 #include <boost/program_options.hpp>
 
+#include <ctype.h>
 #include <stdio.h>
 
+#include <atomic>
 #include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace po = boost::program_options;
 
@@ -70,30 +82,455 @@ static bool getAreaSize(const string& paper_size, int& area_width, int& area_hei
 
 struct CmdLineParams
 {
+    int rows;
+    int cols;
     string output_filename;
     string shape;
     string paper_size;
+    string start_order;
+    string algorithm;
+    string difficulty;
+    string exits;
+    string regenerate;
+    string journal_filename;
+    string animation_filename;
+    string svg_mode;
+    string render_profile;
+    string png_format;
+    int animation_frames;
+    double animation_duration;
+    unsigned random_seed;
+    unsigned regenerate_seed;
     int stroke_width;
     int cell_width;
     int cell_height;
+    int num_threads;
+    int count;
+    int num_jobs;
+    int best_of;
+    bool print_stats;
+    bool report;
+    bool answer_key;
     bool no_maze;
     bool no_exits;
+    bool no_antialias;
 };
 
+// Grid size (rows, cols) fitting the paper unless it is set on the command line
+static std::tuple<int, int> gridSize(const CmdLineParams& params, std::tuple<int, int> fit_size) {
+    auto [rows, cols] = fit_size;
+    if (params.rows > 0) {
+        rows = params.rows;
+    }
+    if (params.cols > 0) {
+        cols = params.cols;
+    }
+    return {rows, cols};
+}
+
+// Checks that `pattern` has exactly one %d conversion for the maze number, zero padding and a width are
+// allowed (e.g. "maze_%04d.svg")
+static bool isValidOutputPattern(const string& pattern) {
+    const auto pos = pattern.find('%');
+    if (pos == string::npos || pattern.find('%', pos + 1) != string::npos) {
+        return false;
+    }
+    auto k = pos + 1;
+    while (k < pattern.size() && isdigit(static_cast<unsigned char>(pattern[k]))) {
+        k++;
+    }
+    return k < pattern.size() && pattern[k] == 'd';
+}
+
+// Output filename of maze `number` (the pattern must be valid, see isValidOutputPattern)
+static string outputFilename(const string& pattern, int number) {
+    const auto size = snprintf(nullptr, 0, pattern.c_str(), number);
+    string name(size, '\0');
+    snprintf(name.data(), name.size() + 1, pattern.c_str(), number);
+    return name;
+}
+
+enum class ECellShape
+{
+    Hex,
+    Square,
+    Brick,
+};
+
+// Where the exits are added
+enum class EExitPlacement
+{
+    Corners,     // Top left and bottom right corners, before the maze is generated (AddExits)
+    LongestPath, // Ends of the longest path between two border cells, after it (AddLongestPathExits)
+};
+
+// Everything needed to generate and draw a maze except the seed and the output file
+struct MazeSetup
+{
+    ECellShape shape;
+    int rows;
+    int cols;
+    CreateMazeParams create_params;
+    EOpenNodeOrder start_order;
+    DrawParams draw_params;
+    ESvgMode svg_mode;
+    // Used for the output files with a .png extension
+    EPixelFormat png_format;
+    bool antialias;
+    bool no_maze;
+    bool no_exits;
+    EExitPlacement exit_placement;
+    // Region regenerated after the maze is created (see IMazeGrid::RegenerateRegion)
+    bool regenerate;
+    NodeIndex2D region_top_left;
+    NodeIndex2D region_bottom_right;
+    unsigned regenerate_seed;
+    int best_of;
+    EDifficulty difficulty;
+    bool report;
+    bool answer_key;
+};
+
+static unique_ptr<IMazeGrid> createGrid(const MazeSetup& setup) {
+    switch (setup.shape) {
+        case ECellShape::Hex: return make_unique<HexMaze>(setup.rows, setup.cols);
+        case ECellShape::Square: return make_unique<SquareMaze>(setup.rows, setup.cols);
+        case ECellShape::Brick: return make_unique<BrickMaze>(setup.rows, setup.cols);
+    }
+    return nullptr;
+}
+
+// Creates the grid of a worker for its first maze, then resets it for the next ones
+static void prepareGrid(unique_ptr<IMazeGrid>& maze, const MazeSetup& setup) {
+    if (maze) {
+        maze->Reset();
+    } else {
+        maze = createGrid(setup);
+    }
+}
+
+static const char* shapeName(ECellShape shape) {
+    switch (shape) {
+        case ECellShape::Hex: return "hex";
+        case ECellShape::Square: return "square";
+        case ECellShape::Brick: return "brick";
+    }
+    return "";
+}
+
+// The names of the --algorithm, --start-order and --exits options
+static const char* algorithmName(EMazeAlgorithm algorithm) {
+    switch (algorithm) {
+        case EMazeAlgorithm::Wilson: return "wilson";
+        case EMazeAlgorithm::Kruskal: return "kruskal";
+        case EMazeAlgorithm::WilsonArrows: return "wilson-arrows";
+    }
+    return "";
+}
+
+static const char* startOrderName(EOpenNodeOrder order) {
+    switch (order) {
+        case EOpenNodeOrder::Scan: return "scan";
+        case EOpenNodeOrder::Random: return "random";
+    }
+    return "";
+}
+
+static const char* exitsName(const MazeSetup& setup) {
+    if (setup.no_exits) {
+        return "none";
+    }
+    switch (setup.exit_placement) {
+        case EExitPlacement::Corners: return "corners";
+        case EExitPlacement::LongestPath: return "longest";
+    }
+    return "";
+}
+
+static void printMetrics(const MazeMetrics& metrics) {
+    cerr << "Solution length: " << metrics.solution_length << "\n"
+         << "Dead ends: " << metrics.dead_ends << "\n"
+         << "Junctions: " << metrics.junctions << " (branching factor " << metrics.branching_factor << ")\n"
+         << "River: " << metrics.river << "\n"
+         << "Longest corridor: " << metrics.longest_corridor << "\n";
+}
+
+// Writes the metrics of the maze as JSON to `filename`
+static bool writeReport(const string& filename, const MazeSetup& setup, unsigned random_seed,
+                        const MazeMetrics& metrics) {
+    ofstream ofs;
+    ofs.open(filename, std::ofstream::out);
+    if (ofs.fail()) {
+        cerr << "Cannot open report file: " << filename << "\n";
+        return false;
+    }
+    ofs << "{\n"
+        << "  \"shape\": \"" << shapeName(setup.shape) << "\",\n"
+        << "  \"rows\": " << setup.rows << ",\n"
+        << "  \"cols\": " << setup.cols << ",\n"
+        << "  \"seed\": " << random_seed << ",\n"
+        << "  \"algorithm\": \"" << algorithmName(setup.create_params.algorithm) << "\",\n"
+        << "  \"threads\": " << setup.create_params.num_threads << ",\n"
+        << "  \"start_order\": \"" << startOrderName(setup.start_order) << "\",\n"
+        << "  \"exits\": \"" << exitsName(setup) << "\",\n";
+    if (setup.regenerate) {
+        ofs << "  \"regenerate\": {\"top\": " << setup.region_top_left.i
+            << ", \"left\": " << setup.region_top_left.j
+            << ", \"bottom\": " << setup.region_bottom_right.i
+            << ", \"right\": " << setup.region_bottom_right.j
+            << ", \"seed\": " << setup.regenerate_seed << "},\n";
+    } else {
+        ofs << "  \"regenerate\": null,\n";
+    }
+    ofs << "  \"cells\": " << metrics.cells << ",\n"
+        << "  \"solution_length\": " << metrics.solution_length << ",\n"
+        << "  \"dead_ends\": " << metrics.dead_ends << ",\n"
+        << "  \"junctions\": " << metrics.junctions << ",\n"
+        << "  \"branching_factor\": " << metrics.branching_factor << ",\n"
+        << "  \"river\": " << metrics.river << ",\n"
+        << "  \"longest_corridor\": " << metrics.longest_corridor << "\n"
+        << "}\n";
+    return true;
+}
+
+static bool isPngFile(const string& filename) {
+    return filesystem::path(filename).extension() == ".png";
+}
+
+// Draws the maze as a PNG image if `filename` has a .png extension, as an SVG image otherwise
+static bool drawMaze(const IMazeGrid& maze, const MazeSetup& setup, const DrawParams& draw_params,
+                     const string& filename) {
+    ofstream ofs;
+    ofs.open(filename, std::ofstream::out | std::ofstream::binary);
+    if (ofs.fail()) {
+        cerr << "Cannot open output file: " << filename << "\n";
+        return false;
+    }
+    if (isPngFile(filename)) {
+        PngPainter painter({draw_params.stroke_width}, setup.png_format, setup.antialias);
+        maze.Draw(painter, draw_params);
+        painter.Write(ofs);
+        return true;
+    }
+    SvgPainter svg_painter(ofs, {draw_params.stroke_width}, setup.svg_mode);
+    PolylinePainter painter(svg_painter);
+    maze.Draw(painter, draw_params);
+    return true;
+}
+
+// Draws the maze to `filename`. If requested, the answer key (the maze with its solution) and the report
+// are written next to it: for maze.svg they are maze_solution.svg and maze.json.
+static bool writeMaze(const IMazeGrid& maze, const MazeSetup& setup, unsigned random_seed, const string& filename) {
+    if (!drawMaze(maze, setup, setup.draw_params, filename)) {
+        return false;
+    }
+
+    if (setup.answer_key) {
+        auto path = std::filesystem::path(filename);
+        path.replace_filename(path.stem().string() + "_solution" + path.extension().string());
+        auto draw_params = setup.draw_params;
+        draw_params.show_solution = true;
+        if (!drawMaze(maze, setup, draw_params, path.string())) {
+            return false;
+        }
+    }
+    if (setup.report) {
+        const auto report_filename = std::filesystem::path(filename).replace_extension(".json").string();
+        return writeReport(report_filename, setup, random_seed, maze.ComputeMetrics());
+    }
+    return true;
+}
+
+// Adds the exits that are placed before the maze is generated
+static void addCornerExits(IMazeGrid& maze, const MazeSetup& setup) {
+    if (!setup.no_exits && setup.exit_placement == EExitPlacement::Corners) {
+        maze.AddExits();
+    }
+}
+
+// Writes the generation recorded in `journal` as an animated SVG of `frame_count` + 1 frames lasting
+// `duration` seconds. The replay starts from a new grid.
+static bool writeAnimation(const MazeSetup& setup, const MazeJournal& journal, int frame_count, double duration,
+                           const string& filename) {
+    ofstream ofs;
+    ofs.open(filename, std::ofstream::out);
+    if (ofs.fail()) {
+        cerr << "Cannot open output file: " << filename << "\n";
+        return false;
+    }
+    auto maze = createGrid(setup);
+    addCornerExits(*maze, setup);
+    AnimatedSvgPainter painter({setup.draw_params.stroke_width});
+    maze->DrawAnimation(painter, setup.draw_params, journal, frame_count);
+    painter.Write(ofs, duration / frame_count);
+    return !ofs.fail();
+}
+
+// Generates a maze in `maze`, which must be a newly created or reset grid. The changes made by the maze
+// generator, the regeneration of the region and the longest path exits are recorded in `journal` unless it
+// is null. The counters of the regeneration go to `regenerate_stats` (optional).
+static ECreateMazeResult generateMaze(IMazeGrid& maze, const MazeSetup& setup, unsigned random_seed,
+                                      CreateMazeStats* stats, CreateMazeStats* regenerate_stats = nullptr,
+                                      MazeJournal* journal = nullptr) {
+    addCornerExits(maze, setup);
+    if (setup.no_maze) {
+        return ECreateMazeResult::Ok;
+    }
+    auto create_params = setup.create_params;
+    create_params.random_seed = random_seed;
+    maze.SetOpenNodeOrder(setup.start_order, random_seed);
+    const auto result = journal ? maze.RecordMaze(create_params, stats, *journal)
+                                : maze.CreateMaze(create_params, stats);
+    if (result == ECreateMazeResult::Ok && setup.regenerate) {
+        if (journal) {
+            maze.RecordRegenerateRegion(setup.region_top_left, setup.region_bottom_right, setup.regenerate_seed,
+                                        regenerate_stats, *journal);
+        } else {
+            maze.RegenerateRegion(setup.region_top_left, setup.region_bottom_right, setup.regenerate_seed,
+                                  regenerate_stats);
+        }
+    }
+    if (result == ECreateMazeResult::Ok && !setup.no_exits && setup.exit_placement == EExitPlacement::LongestPath) {
+        // Recorded, so an animation ends on the same maze as the static output
+        if (journal) {
+            maze.RecordLongestPathExits(*journal);
+        } else {
+            maze.AddLongestPathExits();
+        }
+    }
+    return result;
+}
+
+// The most difficult maze found so far by the workers of a best-of search
+class BestCandidate
+{
+public:
+    // Keeps `maze` if it is more difficult than the best candidate so far (a tie goes to the smaller
+    // candidate number). The previous best is returned in `maze` then, to be reused for the next candidate
+    // (it is null for the first one). Other candidates are abandoned: they are not kept nor drawn.
+    bool offer(unique_ptr<IMazeGrid>& maze, long long score, int number) {
+        lock_guard<mutex> lock(mutex_);
+        if (maze_ && (score < score_ || (score == score_ && number > number_))) {
+            return false;
+        }
+        std::swap(maze_, maze);
+        score_ = score;
+        number_ = number;
+        return true;
+    }
+
+    const IMazeGrid* maze() const { return maze_.get(); }
+    int number() const { return number_; }
+
+private:
+    mutex mutex_;
+    unique_ptr<IMazeGrid> maze_;
+    long long score_ = 0;
+    int number_ = -1;
+};
+
+// Generates candidate `number` of a best-of search with `random_seed` in `maze` and offers it to `best`
+static bool generateCandidate(unique_ptr<IMazeGrid>& maze, const MazeSetup& setup, unsigned random_seed,
+                              int number, BestCandidate& best) {
+    prepareGrid(maze, setup);
+    if (generateMaze(*maze, setup, random_seed, nullptr) != ECreateMazeResult::Ok) {
+        cerr << "Maze generation failed\n";
+        return false;
+    }
+    best.offer(maze, difficultyScore(maze->ComputeMetrics(), setup.difficulty), number);
+    return true;
+}
+
+// The maze is written while it is generated, the grid is never stored
+static bool writeEllerMaze(const MazeSetup& setup, unsigned random_seed, const string& filename) {
+    ofstream ofs;
+    ofs.open(filename, std::ofstream::out | std::ofstream::binary);
+    if (ofs.fail()) {
+        cerr << "Cannot open output file: " << filename << "\n";
+        return false;
+    }
+    SquareMazeStream maze(setup.rows, setup.cols, random_seed);
+    if (!setup.no_exits) {
+        maze.AddExits();
+    }
+    if (isPngFile(filename)) {
+        // The image is in memory anyway
+        PngPainter painter({setup.draw_params.stroke_width}, setup.png_format, setup.antialias);
+        maze.Draw(painter, setup.draw_params);
+        painter.Write(ofs);
+        return true;
+    }
+    SvgPainter painter(ofs, {setup.draw_params.stroke_width});
+    maze.Draw(painter, setup.draw_params);
+    return true;
+}
+
+// Runs `count` jobs on `num_jobs` threads. Every thread creates its own worker with `make_worker()`
+// (e.g. to allocate a grid once) and takes the next job number from a shared counter until all jobs are
+// taken, so the threads that finish early take more jobs. The worker returns false on error, the jobs
+// not started yet are skipped then.
+template< typename MakeWorker >
+static bool runJobs(int count, int num_jobs, MakeWorker make_worker) {
+    atomic<int> next_job = 0;
+    atomic<bool> failed = false;
+    const auto run = [&] {
+        auto worker = make_worker();
+        for (auto job = next_job++; job < count && !failed; job = next_job++) {
+            if (!worker(job)) {
+                failed = true;
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (int k = 1; k < num_jobs; k++) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return !failed;
+}
+
 int main(int argc, char** argv)
 {
     po::options_description desc("Allowed options");
     CmdLineParams params;
     desc.add_options()
         ("help", "Produce this help message")
-        ("output-file,o", po::value<string>(&params.output_filename)->default_value("output.svg"), "Output filename")
+        ("output-file,o", po::value<string>(&params.output_filename)->default_value("output.svg"), "Output filename, the maze is drawn as a PNG image if it has a .png extension")
         ("cell-shape,C", po::value<string>(&params.shape)->default_value("hex"), "Cell shape: hexagonal, square, or brick")
         ("paper-size,s", po::value<string>(&params.paper_size)->default_value("A4"), "Paper size")
         ("stroke-width", po::value<int>(&params.stroke_width)->default_value(4), "Stroke width for walls")
+        ("svg-mode", po::value<string>(&params.svg_mode)->default_value("inline"), "How the SVG elements are written: inline (an element per cell or wall, with its style) or layers (a single path per style, styled by classes; far fewer elements for browsers, not with eller)")
+        ("render-profile", po::value<string>(&params.render_profile)->default_value("print"), "What is drawn: print (walls, solution and the cells that are not white) or debug (all cells)")
+        ("png-format", po::value<string>(&params.png_format)->default_value("rgba"), "Pixel format of PNG output: rgba or gray")
+        ("no-antialias", po::bool_switch(&params.no_antialias), "Do not anti-alias PNG output")
         ("cell-width", po::value<int>(&params.cell_width)->default_value(40), "Cell width")
         ("cell-height", po::value<int>(&params.cell_height)->default_value(40), "Cell height")
+        ("rows", po::value<int>(&params.rows)->default_value(0), "Number of rows (default: fit the paper size)")
+        ("cols", po::value<int>(&params.cols)->default_value(0), "Number of columns (default: fit the paper size)")
         ("no-maze", po::bool_switch(&params.no_maze), "Do not generate a maze, just print the grid (for debugging)")
         ("no-exits", po::bool_switch(&params.no_exits), "Do not add exits at the edges")
+        ("exits", po::value<string>(&params.exits)->default_value("corners"), "Where the exits are added: corners (top left and bottom right) or longest (the two border cells with the longest path between them)")
+        ("algorithm,a", po::value<string>(&params.algorithm)->default_value("wilson"), "Maze generation algorithm: wilson (uniform), wilson-arrows (the same, fewer memory writes), kruskal (faster) or eller (square cells only, streamed row by row)")
+        ("threads,t", po::value<int>(&params.num_threads)->default_value(1), "Number of threads generating the maze")
+        ("start-order", po::value<string>(&params.start_order)->default_value("scan"), "Order of the start nodes of random walks: scan or random")
+        ("seed", po::value<unsigned>(&params.random_seed), "Random seed (default: from the clock, it is written to the --report file)")
+        ("regenerate", po::value<string>(&params.regenerate), "Regenerate the cells of a region after the maze is created, the rest of the maze is kept: top,left,bottom,right (rows and columns from 0, inclusive)")
+        ("regenerate-seed", po::value<unsigned>(&params.regenerate_seed)->default_value(1), "Random seed of --regenerate, try others to get other variants of the region")
+        ("journal", po::value<string>(&params.journal_filename), "Record every change of the maze generation into this file (a compact binary journal for replays and animations)")
+        ("animation", po::value<string>(&params.animation_filename), "Also write the generation of the maze as an animated SVG to this file")
+        ("animation-frames", po::value<int>(&params.animation_frames)->default_value(200), "Number of frames of --animation, the changes in between are merged")
+        ("animation-duration", po::value<double>(&params.animation_duration)->default_value(10.0), "Length of --animation in seconds")
+        ("count,n", po::value<int>(&params.count)->default_value(1), "Number of mazes to generate. With more than one, the output filename must contain a %d conversion (e.g. maze_%04d.svg) replaced by the maze number from 1")
+        ("jobs,j", po::value<int>(&params.num_jobs)->default_value(0), "Number of mazes generated at the same time with --count (default: number of cores)")
+        ("best-of", po::value<int>(&params.best_of)->default_value(1), "Generate this many candidates of each maze and keep the most difficult one")
+        ("difficulty", po::value<string>(&params.difficulty)->default_value("solution"), "What makes a candidate more difficult with --best-of: solution (longer solution), dead-ends (more dead ends) or corridors (shorter corridors)")
+        ("stats", po::bool_switch(&params.print_stats), "Print statistics of the maze generation")
+        ("answer-key", po::bool_switch(&params.answer_key), "Also write the maze with the path between the exits drawn over it, next to the output file with a _solution suffix")
+        ("report", po::bool_switch(&params.report), "Write the metrics of the maze (solution length, dead ends, junctions, etc.) as JSON next to the output file, with a .json extension")
         ;
     po::variables_map vm;
 
@@ -116,56 +553,296 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    EOpenNodeOrder start_order;
+    if (params.start_order == "scan") {
+        start_order = EOpenNodeOrder::Scan;
+    } else if (params.start_order == "random") {
+        start_order = EOpenNodeOrder::Random;
+    } else {
+        cerr << "Invalid start order\n";
+        return 1;
+    }
+
+    CreateMazeParams create_params;
+    create_params.num_threads = params.num_threads;
+    if (params.algorithm == "wilson") {
+        create_params.algorithm = EMazeAlgorithm::Wilson;
+    } else if (params.algorithm == "wilson-arrows") {
+        create_params.algorithm = EMazeAlgorithm::WilsonArrows;
+    } else if (params.algorithm == "kruskal") {
+        create_params.algorithm = EMazeAlgorithm::Kruskal;
+    } else if (params.algorithm != "eller") {
+        cerr << "Invalid algorithm\n";
+        return 1;
+    }
+
+    if (params.count < 1) {
+        cerr << "Invalid count\n";
+        return 1;
+    }
+    if (params.count > 1 && !isValidOutputPattern(params.output_filename)) {
+        cerr << "The output filename must contain a %d conversion with --count\n";
+        return 1;
+    }
+    if (params.best_of < 1) {
+        cerr << "Invalid number of candidates\n";
+        return 1;
+    }
+    EDifficulty difficulty;
+    if (params.difficulty == "solution") {
+        difficulty = EDifficulty::SolutionLength;
+    } else if (params.difficulty == "dead-ends") {
+        difficulty = EDifficulty::DeadEnds;
+    } else if (params.difficulty == "corridors") {
+        difficulty = EDifficulty::Corridors;
+    } else {
+        cerr << "Invalid difficulty\n";
+        return 1;
+    }
+    EExitPlacement exit_placement;
+    if (params.exits == "corners") {
+        exit_placement = EExitPlacement::Corners;
+    } else if (params.exits == "longest") {
+        exit_placement = EExitPlacement::LongestPath;
+    } else {
+        cerr << "Invalid exit placement\n";
+        return 1;
+    }
+    ESvgMode svg_mode;
+    if (params.svg_mode == "inline") {
+        svg_mode = ESvgMode::Inline;
+    } else if (params.svg_mode == "layers") {
+        svg_mode = ESvgMode::Layers;
+    } else {
+        cerr << "Invalid SVG mode\n";
+        return 1;
+    }
+    ERenderProfile render_profile;
+    if (params.render_profile == "print") {
+        render_profile = ERenderProfile::Print;
+    } else if (params.render_profile == "debug") {
+        render_profile = ERenderProfile::Debug;
+    } else {
+        cerr << "Invalid render profile\n";
+        return 1;
+    }
+    EPixelFormat png_format;
+    if (params.png_format == "rgba") {
+        png_format = EPixelFormat::Rgba;
+    } else if (params.png_format == "gray") {
+        png_format = EPixelFormat::Gray;
+    } else {
+        cerr << "Invalid PNG format\n";
+        return 1;
+    }
+    if (params.num_jobs < 0) {
+        cerr << "Invalid number of jobs\n";
+        return 1;
+    }
+    if (params.num_jobs == 0) {
+        params.num_jobs = max(1, static_cast<int>(thread::hardware_concurrency()));
+    }
+
     // TODO: Add validation for stroke_width, cell_width, cell_height
 
-    // Create grid with the selected cell shape
-    unique_ptr<IMazeGrid> maze;
+    MazeSetup setup;
+    setup.create_params = create_params;
+    setup.start_order = start_order;
+    setup.draw_params = {params.cell_width, params.cell_height, params.stroke_width};
+    setup.draw_params.profile = render_profile;
+    setup.svg_mode = svg_mode;
+    setup.png_format = png_format;
+    setup.antialias = !params.no_antialias;
+    setup.no_maze = params.no_maze;
+    setup.no_exits = params.no_exits;
+    setup.exit_placement = exit_placement;
+    setup.regenerate = !params.regenerate.empty();
+    setup.regenerate_seed = params.regenerate_seed;
+    setup.best_of = params.best_of;
+    setup.difficulty = difficulty;
+    setup.report = params.report;
+    setup.answer_key = params.answer_key;
+
+    // Grid size of the selected cell shape
+    const auto is_square = params.shape == "sqr" || params.shape == "square";
     if (params.shape == "hex" || params.shape == "hexagonal") {
-        const auto &[rows, cols] = HexMaze::ComputeGridSize(area_width, area_height,
-                                                            params.cell_width, params.stroke_width);
-        maze = make_unique<HexMaze>(rows, cols);
-    } else if (params.shape == "sqr" || params.shape == "square") {
-        const auto &[rows, cols] = SquareMaze::ComputeGridSize(area_width, area_height,
-                                                               params.cell_width, params.cell_height,
-                                                               params.stroke_width);
-        maze = make_unique<SquareMaze>(rows, cols);
+        setup.shape = ECellShape::Hex;
+        tie(setup.rows, setup.cols) = gridSize(params, HexMaze::ComputeGridSize(area_width, area_height,
+                                                                                params.cell_width, params.stroke_width));
+    } else if (is_square) {
+        setup.shape = ECellShape::Square;
+        tie(setup.rows, setup.cols) = gridSize(params, SquareMaze::ComputeGridSize(area_width, area_height,
+                                                                                   params.cell_width, params.cell_height,
+                                                                                   params.stroke_width));
     } else if (params.shape == "brick") {
-        const auto &[rows, cols] = BrickMaze::ComputeGridSize(area_width, area_height,
-                                                              params.cell_width, params.cell_height,
-                                                              params.stroke_width);
-        maze = make_unique<BrickMaze>(rows, cols);
+        setup.shape = ECellShape::Brick;
+        tie(setup.rows, setup.cols) = gridSize(params, BrickMaze::ComputeGridSize(area_width, area_height,
+                                                                                  params.cell_width, params.cell_height,
+                                                                                  params.stroke_width));
     } else {
         cerr << "Invalid cell shape\n";
         return 1;
     }
 
-    if (!params.no_exits) {
-        maze->AddExits();
+    if (params.algorithm == "eller" && !is_square) {
+        cerr << "Eller's algorithm only supports square cells\n";
+        return 1;
+    }
+    if (params.algorithm == "eller" && params.no_maze) {
+        cerr << "Eller's algorithm streams a generated maze, it cannot be used with --no-maze\n";
+        return 1;
+    }
+    if ((params.report || params.answer_key) && params.algorithm == "eller") {
+        cerr << "Reports and answer keys are not supported with Eller's algorithm\n";
+        return 1;
+    }
+    if (setup.regenerate) {
+        auto& top_left = setup.region_top_left;
+        auto& bottom_right = setup.region_bottom_right;
+        auto length = 0;
+        if (sscanf(params.regenerate.c_str(), "%d,%d,%d,%d%n", &top_left.i, &top_left.j,
+                   &bottom_right.i, &bottom_right.j, &length) != 4 ||
+            length != static_cast<int>(params.regenerate.size()) ||
+            top_left.i < 0 || top_left.i > bottom_right.i || bottom_right.i >= setup.rows ||
+            top_left.j < 0 || top_left.j > bottom_right.j || bottom_right.j >= setup.cols) {
+            cerr << "Invalid region\n";
+            return 1;
+        }
+        if (params.algorithm == "eller" || params.no_maze) {
+            cerr << "Regeneration needs a generated maze (not supported with Eller's algorithm)\n";
+            return 1;
+        }
+    }
+    const auto record = !params.journal_filename.empty() || !params.animation_filename.empty();
+    if (record && (params.count > 1 || params.best_of > 1 || params.algorithm == "eller" || params.no_maze)) {
+        cerr << "Journals and animations can only be recorded for a single generated maze (not with Eller's algorithm)\n";
+        return 1;
+    }
+    if (params.animation_frames < 1 || params.animation_duration <= 0.0) {
+        cerr << "Invalid animation frames or duration\n";
+        return 1;
+    }
+    if (svg_mode == ESvgMode::Layers && params.algorithm == "eller") {
+        cerr << "The layers SVG mode is not supported with Eller's algorithm, its maze is written while it is generated\n";
+        return 1;
+    }
+    if (exit_placement == EExitPlacement::LongestPath && params.algorithm == "eller") {
+        cerr << "Longest path exits are not supported with Eller's algorithm\n";
+        return 1;
+    }
+    if (params.best_of > 1 && (params.algorithm == "eller" || params.no_maze)) {
+        cerr << "Best-of search needs a generated maze (not supported with Eller's algorithm)\n";
+        return 1;
     }
 
-    if (!params.no_maze) {
-        // Compute the maze
-        const auto random_seed = std::chrono::system_clock::now().time_since_epoch().count();
-        maze->CreateMaze(random_seed);
+    // Mazes of a batch and the candidates of a best-of search get consecutive seeds
+    const auto random_seed = vm.count("seed") ? params.random_seed
+        : static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count());
+
+    if (params.count > 1) {
+        const auto start_time = std::chrono::steady_clock::now();
+        const auto ok = runJobs(params.count, min(params.num_jobs, params.count), [&] {
+            // Each worker reuses its grid for all of its mazes
+            unique_ptr<IMazeGrid> maze;
+            return [&setup, &params, random_seed, maze = std::move(maze)](int job) mutable {
+                const auto seed = random_seed + static_cast<unsigned>(job * setup.best_of);
+                const auto filename = outputFilename(params.output_filename, job + 1);
+                if (params.algorithm == "eller") {
+                    return writeEllerMaze(setup, seed, filename);
+                }
+                if (setup.best_of > 1) {
+                    // The candidates of a maze are generated by the same worker, the batch runs in parallel
+                    BestCandidate best;
+                    for (int number = 0; number < setup.best_of; number++) {
+                        if (!generateCandidate(maze, setup, seed + number, number, best)) {
+                            return false;
+                        }
+                    }
+                    return writeMaze(*best.maze(), setup, seed + best.number(), filename);
+                }
+                prepareGrid(maze, setup);
+                if (generateMaze(*maze, setup, seed, nullptr) != ECreateMazeResult::Ok) {
+                    cerr << "Maze generation failed: " << filename << "\n";
+                    return false;
+                }
+                return writeMaze(*maze, setup, seed, filename);
+            };
+        });
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+        if (params.print_stats) {
+            cerr << "Mazes: " << params.count << " (" << min(params.num_jobs, params.count) << " jobs)\n"
+                 << "Time: " << elapsed.count() << " s\n"
+                 << "Mazes per second: " << params.count / elapsed.count() << "\n";
+        }
+        return ok ? 0 : 1;
     }
 
-    ofstream ofs;
-    ofs.open(params.output_filename, std::ofstream::out);
-    if (ofs.fail()) {
-        cerr << "Cannot open output file: " << params.output_filename << "\n";
-        return 1;
+    if (params.algorithm == "eller") {
+        return writeEllerMaze(setup, random_seed, params.output_filename) ? 0 : 1;
     }
 
-    SvgPainter painter(ofs, {params.stroke_width});
-    maze->Draw(painter, {params.cell_width, params.cell_height, params.stroke_width});
+    if (params.best_of > 1) {
+        // The candidates are generated in parallel, only the best one is drawn
+        BestCandidate best;
+        const auto start_time = std::chrono::steady_clock::now();
+        const auto ok = runJobs(params.best_of, min(params.num_jobs, params.best_of), [&] {
+            unique_ptr<IMazeGrid> maze;
+            return [&setup, &best, random_seed, maze = std::move(maze)](int number) mutable {
+                return generateCandidate(maze, setup, random_seed + number, number, best);
+            };
+        });
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+        if (!ok) {
+            return 1;
+        }
+        if (params.print_stats) {
+            cerr << "Candidates: " << params.best_of << " (best: " << best.number() + 1 << ")\n";
+            printMetrics(best.maze()->ComputeMetrics());
+            cerr << "Time: " << elapsed.count() << " s\n";
+        }
+        return writeMaze(*best.maze(), setup, random_seed + best.number(), params.output_filename) ? 0 : 1;
+    }
 
-    // m.setOnChangeHook([&counter, &m]{
-    //     char buffer[64];
-    //     snprintf(buffer, sizeof(buffer), "test_%06d.svg", counter);
-    //     save_image(buffer, m);
-    //     counter++;
-    //     if (counter == 1000) exit(0);
-    // });
+    auto maze = createGrid(setup);
+    CreateMazeStats stats;
+    CreateMazeStats regenerate_stats;
+    MazeJournal journal;
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto result = generateMaze(*maze, setup, random_seed, &stats, &regenerate_stats,
+                                     record ? &journal : nullptr);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+    if (result != ECreateMazeResult::Ok) {
+        cerr << "Maze generation failed\n";
+        return 1;
+    }
+    if (params.print_stats && !params.no_maze) {
+        cerr << "Wilson steps: " << stats.wilson_steps
+             << " (" << stats.wilson_walks << " walks)\n";
+        if (setup.regenerate) {
+            cerr << "Regeneration steps: " << regenerate_stats.wilson_steps
+                 << " (" << regenerate_stats.wilson_walks << " walks)\n";
+        }
+        printMetrics(maze->ComputeMetrics());
+        cerr << "Time: " << elapsed.count() << " s\n";
+    }
+
+    if (!writeMaze(*maze, setup, random_seed, params.output_filename)) {
+        return 1;
+    }
+    if (!params.animation_filename.empty() &&
+        !writeAnimation(setup, journal, params.animation_frames, params.animation_duration, params.animation_filename)) {
+        return 1;
+    }
+    if (!params.journal_filename.empty()) {
+        ofstream ofs(params.journal_filename, std::ofstream::binary);
+        if (ofs.fail() || !journal.save(ofs)) {
+            cerr << "Cannot write journal file: " << params.journal_filename << "\n";
+            return 1;
+        }
+    }
+    if (record && params.print_stats) {
+        cerr << "Journal: " << journal.changeCount() << " changes, " << journal.byteCount() << " bytes\n";
+    }
 
     return 0;
 }
@@ -2,6 +2,10 @@
 
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
 
 template< typename T >
 class MatrixRow
@@ -82,3 +86,113 @@ private:
     int cols_;
     T* m_;
 };
+
+// Matrix of small unsigned values (0 <= value < 2^Bits) packed into 64-bit words
+//
+// Used for the node and edge states of the grids, which have four values each. With 2 bits per entry it
+// takes 16 times less memory than Matrix<int> (8 times less than Matrix<char>), so much larger grids fit
+// in the caches. Entries are read as int and written through a proxy, so the same expressions work as
+// with Matrix (m[i][j] = v, int v = m[i][j]). Entries are laid out row by row without padding.
+template< int Bits >
+class PackedMatrix
+{
+    static_assert(Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8, "Entries must not span words");
+
+    static constexpr int PER_WORD = 64 / Bits;
+    static constexpr uint64_t MASK = (uint64_t(1) << Bits) - 1;
+
+public:
+    // Proxy for a single entry
+    class Reference
+    {
+    public:
+        Reference(uint64_t& word, int shift): word_(word), shift_(shift) {}
+
+        operator int() const { return static_cast<int>((word_ >> shift_) & MASK); }
+
+        Reference& operator=(int value)
+        {
+            assert(0 <= value && static_cast<uint64_t>(value) <= MASK);
+            word_ = (word_ & ~(MASK << shift_)) | (static_cast<uint64_t>(value) << shift_);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) { return *this = static_cast<int>(other); }
+
+    private:
+        uint64_t& word_;
+        int shift_;
+    };
+
+    class Row
+    {
+    public:
+        Row(uint64_t* m, int cols, int row): m_(m), cols_(cols), row_(row) {}
+
+        Reference operator[](int j)
+        {
+            assert(0 <= j && j < cols_);
+            const auto k = static_cast<unsigned>(cols_ * row_ + j);
+            return {m_[k / PER_WORD], static_cast<int>(k % PER_WORD) * Bits};
+        }
+
+    private:
+        uint64_t* m_;
+        int cols_;
+        int row_;
+    };
+
+    class ConstRow
+    {
+    public:
+        ConstRow(const uint64_t* m, int cols, int row): m_(m), cols_(cols), row_(row) {}
+
+        int operator[](int j) const
+        {
+            assert(0 <= j && j < cols_);
+            const auto k = static_cast<unsigned>(cols_ * row_ + j);
+            return static_cast<int>((m_[k / PER_WORD] >> ((k % PER_WORD) * Bits)) & MASK);
+        }
+
+    private:
+        const uint64_t* m_;
+        int cols_;
+        int row_;
+    };
+
+    PackedMatrix(const PackedMatrix&) = delete;
+    PackedMatrix& operator=(const PackedMatrix&) = delete;
+
+    PackedMatrix(int rows, int cols): rows_(rows), cols_(cols)
+    {
+        assert(rows > 0);
+        assert(cols > 0);
+        m_.assign((static_cast<size_t>(rows) * cols + PER_WORD - 1) / PER_WORD, 0);
+    }
+
+    ConstRow operator[](int i) const
+    {
+        assert(0 <= i && i < rows_);
+        return {m_.data(), cols_, i};
+    }
+
+    Row operator[](int i)
+    {
+        assert(0 <= i && i < rows_);
+        return {m_.data(), cols_, i};
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    // Sets all entries to 0, the size is kept
+    void clear() { std::fill(m_.begin(), m_.end(), 0); }
+
+    // Size of the storage in bytes
+    size_t memoryUsage() const { return m_.size() * sizeof(uint64_t); }
+
+private:
+    int rows_;
+    int cols_;
+    std::vector<uint64_t> m_;
+};
@@ -2,6 +2,16 @@
 
 #include "painter.h"
 #include "gen_wilson.h"
+#include "maze_metrics.h"
+#include "node_index_2d.h"
+#include "open_node_index.h"
+
+// Which layers of a maze are drawn
+enum class ERenderProfile
+{
+    Debug, // Everything
+    Print, // All but the visited cells, white on the white background: walls, solution, open and masked cells
+};
 
 struct DrawParams
 {
@@ -11,14 +21,67 @@ struct DrawParams
     int cell_height;
     // Wall width
     int stroke_width;
+    // Draw the path between the exits over the maze
+    bool show_solution = false;
+    ERenderProfile profile = ERenderProfile::Debug;
+
+    // Whether the cells of `style` are drawn
+    bool isCellDrawn(IPainter::EStyle style) const {
+        return profile == ERenderProfile::Debug || style != IPainter::EStyle::VisitedCell;
+    }
 };
 
+enum class EMazeAlgorithm
+{
+    Wilson,       // Uniform spanning tree (CreateMazeWilson, or CreateMazeWilsonParallel with more threads)
+    Kruskal,      // Near-linear but not uniform (CreateMazeKruskal)
+    WilsonArrows, // Same maze as Wilson with one thread, last exit formulation (CreateMazeWilsonArrows)
+};
+
+struct CreateMazeParams
+{
+    unsigned random_seed = 0;
+    EMazeAlgorithm algorithm = EMazeAlgorithm::Wilson;
+    // Number of threads running random walks at the same time (Wilson only)
+    int num_threads = 1;
+};
+
+class MazeJournal;
+template< typename Maze > class MazeGenerators;
+
 class IMazeGrid
 {
 public:
     virtual ~IMazeGrid() = default;
 
     virtual void AddExits() = 0;
-    virtual ECreateMazeResult CreateMaze(unsigned random_seed) = 0;
+    // Adds exits to a generated maze (instead of AddExits) at the two border cells with the longest path
+    // between them (see MazeSolver::findLongestPath)
+    virtual void AddLongestPathExits() = 0;
+    // Same as AddLongestPathExits, and the opened walls are appended to `journal` (see RecordMaze)
+    virtual void RecordLongestPathExits(MazeJournal& journal) = 0;
+    // Restores the state of a newly created grid of the same size (no exits, no invalid regions), so the
+    // grid can be reused for another maze. The open node order is kept.
+    virtual void Reset() = 0;
+    // `stats` is optional, it is filled by the generators supporting it
+    virtual ECreateMazeResult CreateMaze(const CreateMazeParams& params, CreateMazeStats* stats) = 0;
+    // Same as CreateMaze, and every change of a node or an edge is appended to `journal` (see JournalRecorder).
+    // The maze is generated by a single thread.
+    virtual ECreateMazeResult RecordMaze(const CreateMazeParams& params, CreateMazeStats* stats,
+                                         MazeJournal& journal) = 0;
+    // Regenerates the cells of the rectangle from `top_left` to `bottom_right` of a generated maze, the rest
+    // of the maze is kept (see RegenerateRegionWilson). `stats` is optional.
+    virtual void RegenerateRegion(NodeIndex2D top_left, NodeIndex2D bottom_right, unsigned random_seed,
+                                  CreateMazeStats* stats) = 0;
+    // Same as RegenerateRegion, and the changed edges are appended to `journal` (see RecordMaze)
+    virtual void RecordRegenerateRegion(NodeIndex2D top_left, NodeIndex2D bottom_right, unsigned random_seed,
+                                        CreateMazeStats* stats, MazeJournal& journal) = 0;
+    // Metrics of the generated maze (see computeMazeMetrics)
+    virtual MazeMetrics ComputeMetrics() const = 0;
     virtual void Draw(IPainter& painter, const DrawParams& p) const = 0;
+    // Draws the generation recorded in `journal` (see RecordMaze) as `frame_count` + 1 frames, this grid
+    // must be in the state the recorded one was before CreateMaze (see drawJournalFrames)
+    virtual void DrawAnimation(IPainter& painter, const DrawParams& p, const MazeJournal& journal,
+                               int frame_count) = 0;
+    virtual void SetOpenNodeOrder(EOpenNodeOrder order, unsigned random_seed) = 0;
 };
@@ -0,0 +1,119 @@
+#include "maze_journal.h"
+
+#include <assert.h>
+#include <string.h>
+
+using namespace std;
+
+static constexpr char MAGIC[4] = {'M', 'Z', 'J', '1'};
+static constexpr int EDGE_BITS = 3;
+static constexpr int STATE_BITS = 2;
+static constexpr size_t LOAD_CHUNK_SIZE = 64 * 1024;
+
+static void writeVarint(vector<uint8_t>& data, uint64_t value) {
+    while (value >= 0x80) {
+        data.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+// Decodes the varint at `offset` of `data` and moves `offset` past it. Returns false if it is truncated.
+static bool readVarint(const uint8_t* data, size_t size, size_t& offset, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < size; shift += 7) {
+        const auto byte = data[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MazeJournal::clear() {
+    data_.clear();
+    change_count_ = 0;
+    last_node_id_ = 0;
+}
+
+void MazeJournal::append(const MazeChange& change) {
+    assert(0 <= change.edge && change.edge < (1 << EDGE_BITS));
+    assert(0 <= change.state && change.state < (1 << STATE_BITS));
+    const auto delta = static_cast<int64_t>(change.node_id) - last_node_id_;
+    const auto zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+    writeVarint(data_, (zigzag << (EDGE_BITS + STATE_BITS)) | (change.edge << STATE_BITS) | change.state);
+    last_node_id_ = change.node_id;
+    change_count_++;
+}
+
+bool MazeJournal::read(Position& pos, MazeChange& change) const {
+    uint64_t code;
+    if (!readVarint(data_.data(), data_.size(), pos.offset, code)) {
+        return false;
+    }
+    const auto zigzag = code >> (EDGE_BITS + STATE_BITS);
+    const auto delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    pos.node_id = static_cast<int>(pos.node_id + delta);
+    change.node_id = pos.node_id;
+    change.edge = static_cast<int>((code >> STATE_BITS) & ((1 << EDGE_BITS) - 1));
+    change.state = static_cast<int>(code & ((1 << STATE_BITS) - 1));
+    return true;
+}
+
+bool MazeJournal::save(ostream& os) const {
+    vector<uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+    writeVarint(header, static_cast<uint64_t>(change_count_));
+    writeVarint(header, data_.size());
+    os.write(reinterpret_cast<const char*>(header.data()), header.size());
+    os.write(reinterpret_cast<const char*>(data_.data()), data_.size());
+    return !os.fail();
+}
+
+bool MazeJournal::load(istream& is) {
+    clear();
+    char magic[sizeof(MAGIC)];
+    if (!is.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    // The sizes are read a byte at a time
+    uint64_t sizes[2];
+    for (auto& size : sizes) {
+        uint8_t bytes[10];
+        size_t length = 0;
+        size_t offset = 0;
+        do {
+            const auto c = is.get();
+            if (c == istream::traits_type::eof()) {
+                return false;
+            }
+            bytes[length++] = static_cast<uint8_t>(c);
+        } while ((bytes[length - 1] & 0x80) != 0 && length < sizeof(bytes));
+        if (!readVarint(bytes, length, offset, size)) {
+            return false;
+        }
+    }
+    // The data is read in chunks, so a corrupt size cannot allocate more memory than the stream holds
+    while (data_.size() < sizes[1]) {
+        const auto offset = data_.size();
+        const auto chunk = static_cast<size_t>(min<uint64_t>(sizes[1] - offset, LOAD_CHUNK_SIZE));
+        data_.resize(offset + chunk);
+        if (!is.read(reinterpret_cast<char*>(data_.data() + offset), chunk)) {
+            clear();
+            return false;
+        }
+    }
+
+    // Count the changes and find the last node id, so more changes can be appended
+    Position pos;
+    MazeChange change;
+    while (read(pos, change)) {
+        change_count_++;
+    }
+    if (pos.offset != data_.size() || change_count_ != static_cast<long long>(sizes[0])) {
+        clear();
+        return false;
+    }
+    last_node_id_ = pos.node_id;
+    return true;
+}
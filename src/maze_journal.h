@@ -0,0 +1,232 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "maze_grid.h"
+#include "painter.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// A change of a node (edge == 0) or of an edge of a node. `state` is the new ENode or EEdge value.
+struct MazeChange
+{
+    int node_id;
+    int edge;
+    int state;
+};
+
+// Compact binary journal of the changes of a maze, to replay its generation (see MazeJournalReplayer)
+//
+// A change is a single varint (LEB128): the difference of its node id from the node id of the previous
+// change (zigzag encoded), followed by 3 bits for the edge and 2 bits for the state. The walks move
+// between adjacent nodes, so most changes take one or two bytes.
+class MazeJournal
+{
+public:
+    // Where a change is in the journal: its offset in the data and the node id of the change before it
+    // (the base of the difference)
+    struct Position
+    {
+        size_t offset = 0;
+        int node_id = 0;
+    };
+
+    void clear();
+    void append(const MazeChange& change);
+
+    // Decodes the change at `pos` and moves `pos` to the next one. Returns false at the end of the journal.
+    bool read(Position& pos, MazeChange& change) const;
+
+    long long changeCount() const { return change_count_; }
+    size_t byteCount() const { return data_.size(); }
+
+    // The journal in a file: a header (magic and sizes) followed by the data. load() returns false if the
+    // stream is not a journal, the journal is cleared then.
+    bool save(std::ostream& os) const;
+    bool load(std::istream& is);
+
+private:
+    std::vector<uint8_t> data_;
+    long long change_count_ = 0;
+    // Node id of the last change
+    int last_node_id_ = 0;
+};
+
+// Generator observer appending the node and edge changes to a journal (see NullMazeObserver)
+template< typename Maze >
+class JournalRecorder
+{
+public:
+    JournalRecorder(MazeJournal& journal, const Maze& maze): journal_(&journal), maze_(&maze) {}
+
+    void onEvent(const NodeChangedEvent<typename Maze::NodeIndex>& event) {
+        journal_->append({maze_->nodeId(event.node), 0, static_cast<int>(event.state)});
+    }
+    void onEvent(const EdgeChangedEvent<typename Maze::NodeIndex>& event) {
+        journal_->append({maze_->nodeId(event.node), event.edge, static_cast<int>(event.state)});
+    }
+    template< typename Event >
+    void onEvent(const Event&) {}
+
+private:
+    MazeJournal* journal_;
+    const Maze* maze_;
+};
+
+// Sets a maze to its state after any number of changes (a frame) of a journal
+//
+// The whole journal is replayed once by the constructor, which takes a keyframe (the state of all nodes
+// and edges, 2 bits each) at regular intervals. A seek restores the last keyframe before the frame, only
+// the nodes and edges that differ are set, and replays the changes from there. Seeking forward from the
+// current frame just replays the changes in between.
+//
+// Type parameter `Maze` is expected to implement getNode, setNode, getEdge and setEdge (see
+// CreateMazeWilson) plus:
+//  static constexpr int EDGE_COUNT;
+//  int nodeCount() const;
+//  NodeIndex nodeFromId(int id) const;
+//
+template< typename Maze >
+class MazeJournalReplayer
+{
+public:
+    // `maze` must be in the state it was before the recorded changes (same size, exits and invalid regions).
+    // It is in the last frame after the constructor. A keyframe is taken every `keyframe_interval` changes,
+    // 0 means one per (1 + EDGE_COUNT) * nodeCount() changes, about the cost of restoring a keyframe.
+    MazeJournalReplayer(const MazeJournal& journal, Maze& maze, long long keyframe_interval = 0);
+
+    // Number of frames: the state before the first change is frame 0, after the last one frameCount()
+    long long frameCount() const { return journal_.changeCount(); }
+    long long frame() const { return frame_; }
+    int keyframeCount() const { return static_cast<int>(keyframes_.size()); }
+
+    // Sets the maze to its state after the first `frame` changes (clamped to the frames of the journal)
+    void seek(long long frame);
+
+private:
+    static constexpr int STATES_PER_NODE = 1 + Maze::EDGE_COUNT;
+
+    struct Keyframe
+    {
+        long long frame;
+        MazeJournal::Position position;
+        // 2 bits for every node and for each of its edges, STATES_PER_NODE per node
+        std::vector<uint8_t> states;
+    };
+
+    // Applies the next change, returns false at the end of the journal
+    bool step();
+    void capture(Keyframe& keyframe) const;
+    void restore(const Keyframe& keyframe);
+
+    const MazeJournal& journal_;
+    Maze& maze_;
+    std::vector<Keyframe> keyframes_;
+    long long frame_ = 0;
+    MazeJournal::Position position_;
+};
+
+template< typename Maze >
+MazeJournalReplayer<Maze>::MazeJournalReplayer(const MazeJournal& journal, Maze& maze, long long keyframe_interval)
+    : journal_(journal)
+    , maze_(maze) {
+    if (keyframe_interval <= 0) {
+        keyframe_interval = static_cast<long long>(STATES_PER_NODE) * maze.nodeCount();
+    }
+    keyframes_.emplace_back();
+    capture(keyframes_.back());
+    while (step()) {
+        if (frame_ % keyframe_interval == 0) {
+            keyframes_.emplace_back();
+            capture(keyframes_.back());
+        }
+    }
+}
+
+template< typename Maze >
+void MazeJournalReplayer<Maze>::seek(long long frame) {
+    frame = std::clamp(frame, 0LL, frameCount());
+    const auto next = std::upper_bound(keyframes_.begin(), keyframes_.end(), frame,
+                                       [](long long f, const Keyframe& keyframe) { return f < keyframe.frame; });
+    const auto& keyframe = *(next - 1);
+    if (frame < frame_ || frame_ < keyframe.frame) {
+        restore(keyframe);
+    }
+    while (frame_ < frame) {
+        step();
+    }
+}
+
+template< typename Maze >
+bool MazeJournalReplayer<Maze>::step() {
+    MazeChange change;
+    if (!journal_.read(position_, change)) {
+        return false;
+    }
+    const auto node = maze_.nodeFromId(change.node_id);
+    if (change.edge == 0) {
+        maze_.setNode(node, static_cast<ENode>(change.state));
+    } else {
+        maze_.setEdge(node, change.edge, static_cast<EEdge>(change.state));
+    }
+    frame_++;
+    return true;
+}
+
+template< typename Maze >
+void MazeJournalReplayer<Maze>::capture(Keyframe& keyframe) const {
+    keyframe.frame = frame_;
+    keyframe.position = position_;
+    keyframe.states.assign((static_cast<size_t>(maze_.nodeCount()) * STATES_PER_NODE + 3) / 4, 0);
+    size_t k = 0;
+    for (int id = 0; id < maze_.nodeCount(); id++) {
+        const auto node = maze_.nodeFromId(id);
+        for (int edge = 0; edge <= Maze::EDGE_COUNT; edge++, k++) {
+            const auto state = edge == 0 ? static_cast<int>(maze_.getNode(node))
+                                         : static_cast<int>(maze_.getEdge(node, edge));
+            keyframe.states[k / 4] |= static_cast<uint8_t>(state << (2 * (k % 4)));
+        }
+    }
+}
+
+template< typename Maze >
+void MazeJournalReplayer<Maze>::restore(const Keyframe& keyframe) {
+    size_t k = 0;
+    for (int id = 0; id < maze_.nodeCount(); id++) {
+        const auto node = maze_.nodeFromId(id);
+        for (int edge = 0; edge <= Maze::EDGE_COUNT; edge++, k++) {
+            const auto state = (keyframe.states[k / 4] >> (2 * (k % 4))) & 3;
+            // Invalid nodes never change. Invalid edges to the outside change when exits are opened after the
+            // maze is generated (see IMazeGrid::RecordLongestPathExits), so they are set back here.
+            if (edge == 0) {
+                if (state != static_cast<int>(maze_.getNode(node))) {
+                    maze_.setNode(node, static_cast<ENode>(state));
+                }
+            } else if (state != static_cast<int>(maze_.getEdge(node, edge))) {
+                maze_.setEdge(node, edge, static_cast<EEdge>(state));
+            }
+        }
+    }
+    frame_ = keyframe.frame;
+    position_ = keyframe.position;
+}
+
+// Draws the replay of `journal` into `painter` as `frame_count` + 1 frames: the state before the first
+// change, then frames evenly spread over the changes up to the last one. Frames between them are skipped,
+// which keeps the cost (and the size of an animation) bounded for any number of changes. `maze` must be
+// in the state it was before the recorded changes, it is in the last frame afterwards.
+template< typename Maze >
+void drawJournalFrames(Maze& maze, const MazeJournal& journal, int frame_count, IPainter& painter,
+                       const DrawParams& p) {
+    MazeJournalReplayer<Maze> replayer(journal, maze);
+    frame_count = std::max(frame_count, 1);
+    for (int frame = 0; frame <= frame_count; frame++) {
+        replayer.seek(replayer.frameCount() * frame / frame_count);
+        maze.Draw(painter, p);
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "maze_solver.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+// Difficulty metrics of a generated maze
+struct MazeMetrics
+{
+    // Cells in the maze
+    int cells = 0;
+    // Number of cells on the path between the first two exits (0 with less than two exits)
+    int solution_length = 0;
+    // Cells with a single opening
+    int dead_ends = 0;
+    // Cells with three or more openings
+    int junctions = 0;
+    // Average number of ways on at a junction (its openings except the one it is entered from)
+    double branching_factor = 0.0;
+    // Average number of cells in the dead-end branches (from the dead end up to the junction it branches
+    // off at). Mazes with a high "river" have fewer but longer dead ends.
+    double river = 0.0;
+    // The most cells in a row with exactly two openings (a corridor without branches)
+    int longest_corridor = 0;
+};
+
+// What makes a maze difficult when candidates are compared
+enum class EDifficulty
+{
+    SolutionLength, // Longer solution
+    DeadEnds,       // More dead ends
+    Corridors,      // Shorter longest corridor (more decisions on the way)
+};
+
+// The score of a maze, higher is more difficult
+inline long long difficultyScore(const MazeMetrics& metrics, EDifficulty difficulty) {
+    switch (difficulty) {
+        case EDifficulty::SolutionLength: return metrics.solution_length;
+        case EDifficulty::DeadEnds: return metrics.dead_ends;
+        case EDifficulty::Corridors: return -metrics.longest_corridor;
+    }
+    return 0;
+}
+
+// Computes the metrics of the maze formed by the visited edges of `maze`. An opening is a visited edge,
+// exits (visited edges leading out of the grid) included.
+//
+// The edges are read once, in a row-major sweep, into a byte per cell with a bit for each opening. The
+// rest works on these bytes only:
+//  - The corridors and the dead-end branches are followed from their ends, so each cell is passed three
+//    times at most.
+//  - The solution is what is left after dead-end filling: cells with a single opening (but no exit) are
+//    removed until there are none.
+// So the whole analysis takes linear time.
+//
+// Type parameter `Maze` is expected to implement getNode, getEdge and nextNode (see CreateMazeWilson) plus:
+//  static constexpr int EDGE_COUNT;
+//  int rows() const;
+//  int cols() const;
+//  int nodeCount() const;
+//  int nodeId(NodeIndex node) const;
+//  NodeIndex nodeFromId(int id) const;
+//
+template< typename Maze >
+MazeMetrics computeMazeMetrics(const Maze& maze) {
+    static_assert(Maze::EDGE_COUNT < 8, "The openings of a cell must fit in a byte");
+    using NodeIndex = Maze::NodeIndex;
+
+    MazeMetrics metrics;
+    const auto node_count = maze.nodeCount();
+    // Bit `e` is set if edge `e` of the cell is open, no bits are set for cells not in the maze
+    std::vector<uint8_t> openings(node_count, 0);
+    std::vector<int> exits;
+    auto ways_on = 0;
+    for (int id = 0; id < node_count; id++) {
+        const auto node = maze.nodeFromId(id);
+        if (maze.getNode(node) != ENode::Visited) {
+            continue;
+        }
+        metrics.cells++;
+        uint8_t mask = 0;
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            if (maze.getEdge(node, edge) == EEdge::Visited) {
+                mask |= 1 << edge;
+                if (!isInsideGrid(maze, Maze::nextNode(node, edge))) {
+                    exits.push_back(id);
+                }
+            }
+        }
+        openings[id] = mask;
+        const auto count = std::popcount(mask);
+        if (count == 1) {
+            metrics.dead_ends++;
+        } else if (count >= 3) {
+            metrics.junctions++;
+            ways_on += count - 1;
+        }
+    }
+    if (metrics.junctions > 0) {
+        metrics.branching_factor = static_cast<double>(ways_on) / metrics.junctions;
+    }
+
+    // True if the cell entered from `node` through `edge` has two openings
+    const auto inCorridor = [&](NodeIndex node, int edge) {
+        const auto next = Maze::nextNode(node, edge);
+        return isInsideGrid(maze, next) && std::popcount(openings[maze.nodeId(next)]) == 2;
+    };
+    // Number of cells with two openings in a row starting at the one entered from `node` through `edge`
+    const auto follow = [&](NodeIndex node, int edge) {
+        auto length = 0;
+        while (inCorridor(node, edge)) {
+            node = Maze::nextNode(node, edge);
+            length++;
+            const auto mask = openings[maze.nodeId(node)] & ~(1 << oppositeEdge<Maze>(edge));
+            edge = std::countr_zero(static_cast<unsigned>(mask));
+        }
+        return length;
+    };
+
+    auto dead_end_cells = 0;
+    for (int id = 0; id < node_count; id++) {
+        const auto mask = static_cast<unsigned>(openings[id]);
+        const auto node = maze.nodeFromId(id);
+        if (std::popcount(mask) == 1) {
+            dead_end_cells += 1 + follow(node, std::countr_zero(mask));
+        } else if (std::popcount(mask) == 2) {
+            // Measure the corridors from their ends only, where the corridor does not go on in one direction
+            const auto first = std::countr_zero(mask);
+            const auto second = std::countr_zero(mask & (mask - 1));
+            if (!inCorridor(node, first)) {
+                metrics.longest_corridor = std::max(metrics.longest_corridor, 1 + follow(node, second));
+            } else if (!inCorridor(node, second)) {
+                metrics.longest_corridor = std::max(metrics.longest_corridor, 1 + follow(node, first));
+            }
+        }
+    }
+    if (metrics.dead_ends > 0) {
+        metrics.river = static_cast<double>(dead_end_cells) / metrics.dead_ends;
+    }
+
+    if (exits.size() >= 2) {
+        // Dead-end filling, the exits count as openings so the cells with an exit are never removed
+        std::vector<uint8_t> degree(node_count);
+        std::vector<int> stack;
+        for (int id = 0; id < node_count; id++) {
+            degree[id] = static_cast<uint8_t>(std::popcount(openings[id]));
+            if (degree[id] == 1 && std::find(exits.begin(), exits.end(), id) == exits.end()) {
+                stack.push_back(id);
+            }
+        }
+        auto removed = 0;
+        while (!stack.empty()) {
+            const auto id = stack.back();
+            stack.pop_back();
+            degree[id] = 0;
+            removed++;
+            const auto node = maze.nodeFromId(id);
+            for (unsigned mask = openings[id]; mask != 0; mask &= mask - 1) {
+                const auto next = Maze::nextNode(node, std::countr_zero(mask));
+                if (!isInsideGrid(maze, next)) {
+                    continue;
+                }
+                const auto next_id = maze.nodeId(next);
+                if (degree[next_id] > 0 && --degree[next_id] == 1 &&
+                    std::find(exits.begin(), exits.end(), next_id) == exits.end()) {
+                    stack.push_back(next_id);
+                }
+            }
+        }
+        metrics.solution_length = metrics.cells - removed;
+    }
+    return metrics;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "gen_wilson.h"
+#include "grid_topology.h"
+
+#include <algorithm>
+#include <vector>
+
+// True if `node` is a node of the grid, nextNode() of a border node leads outside of it
+template< typename Maze >
+bool isInsideGrid(const Maze& maze, typename Maze::NodeIndex node) {
+    return 0 <= node.i && node.i < maze.rows() && 0 <= node.j && node.j < maze.cols();
+}
+
+// The edge of the adjacent node leading back along `edge`, see GridTopology
+template< typename Maze >
+constexpr int oppositeEdge(int edge) {
+    return GridTopology<Maze::EDGE_COUNT, 1>::oppositeEdge(edge);
+}
+
+// Breadth-first search for the path between the exits of a maze
+//
+// The frontier is a flat queue of linear node ids and the parent of each node is kept in a flat array.
+// Both are allocated once and reused by the later solve() calls, so there are no per-node allocations.
+//
+// Type parameter `Maze` is expected to implement getNode, getEdge and nextNode (see CreateMazeWilson) plus:
+//  static constexpr int EDGE_COUNT;
+//  int rows() const;
+//  int cols() const;
+//  int nodeCount() const;
+//  int nodeId(NodeIndex node) const;
+//  NodeIndex nodeFromId(int id) const;
+//
+template< typename Maze >
+class MazeSolver
+{
+public:
+    using NodeIndex = Maze::NodeIndex;
+
+    // Finds the path along the visited edges between the first two exits (visited edges leading out of the
+    // grid, see AddExits) in row-major order. The path starts at the first exit and includes the cells of
+    // both exits. Returns false if there are less than two exits or they are not connected.
+    bool solve(const Maze& maze, std::vector<NodeIndex>& path);
+
+    // Finds the two border cells with the longest path between them. The maze is a tree, so these are the
+    // ends of its diameter restricted to the border cells, found by two searches: the border cell farthest
+    // from any border cell is one end, the border cell farthest from that one is the other. Linear time.
+    // `first` and `second` are the same cell if it is the only border cell in the maze. Returns false if
+    // there are no border cells in the maze.
+    bool findLongestPath(const Maze& maze, NodeIndex& first, NodeIndex& second);
+
+private:
+    bool isBorder(const Maze& maze, NodeIndex node) const {
+        return node.i == 0 || node.i == maze.rows() - 1 || node.j == 0 || node.j == maze.cols() - 1;
+    }
+
+    // Breadth-first search along the visited edges from `start` until `goal` is reached (all the connected
+    // nodes with goal < 0). The reached nodes are in queue_ in the order of their distance from `start`,
+    // the number of them is returned.
+    int search(const Maze& maze, int start, int goal);
+    // The last border cell in queue_[0, count), the farthest one from the start of the search
+    int farthestBorder(const Maze& maze, int count) const;
+
+    std::vector<int> queue_;
+    // Id of the node each node was reached from, -1 if it was not reached yet
+    std::vector<int> parent_;
+};
+
+template< typename Maze >
+bool MazeSolver<Maze>::solve(const Maze& maze, std::vector<NodeIndex>& path) {
+    path.clear();
+
+    // The exits are on the border, the inner cells are skipped
+    int exits[2];
+    auto exit_count = 0;
+    const auto rows = maze.rows();
+    const auto cols = maze.cols();
+    for (int i = 0; i < rows && exit_count < 2; i++) {
+        const auto step = (i == 0 || i == rows - 1) ? 1 : std::max(cols - 1, 1);
+        for (int j = 0; j < cols && exit_count < 2; j += step) {
+            for (int edge = 1; edge <= Maze::EDGE_COUNT && exit_count < 2; edge++) {
+                if (maze.getEdge({i, j}, edge) == EEdge::Visited && !isInsideGrid(maze, Maze::nextNode({i, j}, edge))) {
+                    exits[exit_count++] = maze.nodeId({i, j});
+                }
+            }
+        }
+    }
+    if (exit_count < 2) {
+        return false;
+    }
+
+    const auto start = exits[0];
+    const auto goal = exits[1];
+    search(maze, start, goal);
+    if (parent_[goal] < 0) {
+        return false;
+    }
+
+    for (auto id = goal; id != start; id = parent_[id]) {
+        path.push_back(maze.nodeFromId(id));
+    }
+    path.push_back(maze.nodeFromId(start));
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+template< typename Maze >
+bool MazeSolver<Maze>::findLongestPath(const Maze& maze, NodeIndex& first, NodeIndex& second) {
+    auto start = -1;
+    const auto rows = maze.rows();
+    const auto cols = maze.cols();
+    for (int i = 0; i < rows && start < 0; i++) {
+        const auto step = (i == 0 || i == rows - 1) ? 1 : std::max(cols - 1, 1);
+        for (int j = 0; j < cols && start < 0; j += step) {
+            if (maze.getNode({i, j}) == ENode::Visited) {
+                start = maze.nodeId({i, j});
+            }
+        }
+    }
+    if (start < 0) {
+        return false;
+    }
+
+    const auto first_id = farthestBorder(maze, search(maze, start, -1));
+    const auto second_id = farthestBorder(maze, search(maze, first_id, -1));
+    first = maze.nodeFromId(first_id);
+    second = maze.nodeFromId(second_id);
+    return true;
+}
+
+template< typename Maze >
+int MazeSolver<Maze>::farthestBorder(const Maze& maze, int count) const {
+    for (auto k = count - 1; k > 0; k--) {
+        if (isBorder(maze, maze.nodeFromId(queue_[k]))) {
+            return queue_[k];
+        }
+    }
+    return queue_[0];
+}
+
+template< typename Maze >
+int MazeSolver<Maze>::search(const Maze& maze, int start, int goal) {
+    parent_.assign(maze.nodeCount(), -1);
+    queue_.resize(maze.nodeCount());
+    auto head = 0;
+    auto tail = 0;
+    queue_[tail++] = start;
+    parent_[start] = start;
+    while (head < tail) {
+        const auto id = queue_[head++];
+        if (id == goal) {
+            break;
+        }
+        const auto node = maze.nodeFromId(id);
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            if (maze.getEdge(node, edge) != EEdge::Visited) {
+                continue;
+            }
+            const auto next = Maze::nextNode(node, edge);
+            if (!isInsideGrid(maze, next)) {
+                continue;
+            }
+            const auto next_id = maze.nodeId(next);
+            if (parent_[next_id] < 0) {
+                parent_[next_id] = id;
+                queue_[tail++] = next_id;
+            }
+        }
+    }
+    return tail;
+}
+
+// Opens a closed wall of a border cell to the outside of the grid
+template< typename Maze, typename Observer >
+void openBorderWall(Maze& maze, Observer& observer, typename Maze::NodeIndex node) {
+    for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+        const auto next = Maze::nextNode(node, edge);
+        if (!isInsideGrid(maze, next) && maze.getEdge(node, edge) != EEdge::Visited) {
+            setEdgeObserved(maze, observer, node, edge, EEdge::Visited);
+            return;
+        }
+    }
+}
+
+// Adds the exits at the ends of the longest path between two border cells (see
+// MazeSolver::findLongestPath) to a generated maze. The opened walls are reported to `observer` like the
+// changes of a generator (see NullMazeObserver).
+template< typename Maze, typename Observer = NullMazeObserver >
+void addLongestPathExits(Maze& maze, Observer observer = Observer()) {
+    MazeSolver<Maze> solver;
+    typename Maze::NodeIndex first;
+    typename Maze::NodeIndex second;
+    if (solver.findLongestPath(maze, first, second)) {
+        openBorderWall(maze, observer, first);
+        openBorderWall(maze, observer, second);
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "random.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <vector>
+
+// Order in which getOpenNode() returns the open nodes of a grid
+enum class EOpenNodeOrder
+{
+    Scan,   // Row-major order, the first open node is always returned (compatible with existing seeds)
+    Random, // A random (but fixed) permutation of the nodes
+};
+
+// Set of open nodes identified by their linear index (0 <= id < size).
+//
+// It is a hierarchical bitset: bit k of level L+1 is set iff word k of level L is non-zero. Inserting or
+// erasing a node touches one word per level at most, finding the first node takes one count-trailing-zeros
+// per level. For 10M nodes there are 4 levels, so all operations are effectively constant time.
+//
+// The bits are indexed by rank, not by id. In scan order rank == id, otherwise ranks come from a random
+// permutation, so first() returns the open node with the smallest rank.
+class OpenNodeIndex
+{
+public:
+    // Initially all nodes are open (matching a freshly created grid)
+    explicit OpenNodeIndex(int size): size_(size)
+    {
+        assert(size > 0);
+        auto words = size;
+        do {
+            words = (words + 63) / 64;
+            levels_.emplace_back(words, 0);
+        } while (words > 1);
+
+        reset();
+    }
+
+    // Makes all nodes open again, the order is kept
+    void reset()
+    {
+        for (auto& level : levels_) {
+            std::fill(level.begin(), level.end(), 0);
+        }
+        for (int id = 0; id < size_; id++) {
+            insert(id);
+        }
+    }
+
+    void insert(int id)
+    {
+        auto k = rank(id);
+        for (auto& level : levels_) {
+            auto& word = level[k / 64];
+            const auto was_empty = word == 0;
+            word |= uint64_t{1} << (k % 64);
+            if (!was_empty) {
+                break;
+            }
+            k /= 64;
+        }
+    }
+
+    void erase(int id)
+    {
+        auto k = rank(id);
+        for (auto& level : levels_) {
+            auto& word = level[k / 64];
+            word &= ~(uint64_t{1} << (k % 64));
+            if (word != 0) {
+                break;
+            }
+            k /= 64;
+        }
+    }
+
+    bool contains(int id) const
+    {
+        const auto k = rank(id);
+        return (levels_[0][k / 64] >> (k % 64)) & 1;
+    }
+
+    // Returns the open node with the smallest rank or -1 if there are no open nodes
+    int first() const
+    {
+        if (levels_.back()[0] == 0) {
+            return -1;
+        }
+        int k = 0;
+        for (auto level = levels_.rbegin(); level != levels_.rend(); ++level) {
+            k = 64*k + std::countr_zero((*level)[k]);
+        }
+        return ids_.empty() ? k : ids_[k];
+    }
+
+    // Changes the order of the nodes, the set of open nodes is preserved
+    void setOrder(EOpenNodeOrder order, unsigned random_seed)
+    {
+        std::vector<int> open_ids;
+        for (int id = 0; id < size_; id++) {
+            if (contains(id)) {
+                open_ids.push_back(id);
+            }
+        }
+        for (auto& level : levels_) {
+            std::fill(level.begin(), level.end(), 0);
+        }
+
+        ids_.clear();
+        ranks_.clear();
+        if (order == EOpenNodeOrder::Random) {
+            ids_.resize(size_);
+            ranks_.resize(size_);
+            for (int k = 0; k < size_; k++) {
+                ids_[k] = k;
+            }
+            Pcg32 random_engine(random_seed);
+            randomShuffle(ids_.begin(), ids_.end(), random_engine);
+            for (int k = 0; k < size_; k++) {
+                ranks_[ids_[k]] = k;
+            }
+        }
+
+        for (const auto id : open_ids) {
+            insert(id);
+        }
+    }
+
+    int size() const { return size_; }
+
+private:
+    int rank(int id) const
+    {
+        assert(0 <= id && id < size_);
+        return ranks_.empty() ? id : ranks_[id];
+    }
+
+    int size_;
+    // levels_[0] has a bit for each node, the last level is a single word
+    std::vector<std::vector<uint64_t>> levels_;
+    // Permutation of the nodes (empty in scan order): ids_[rank] == id and ranks_[id] == rank
+    std::vector<int> ids_;
+    std::vector<int> ranks_;
+};
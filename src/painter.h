@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 #include <vector>
 
 struct Point2D
@@ -17,11 +19,19 @@ struct IPainter
         OnPathCell,     // Cell on the current random path
         Wall,           // Wall that is removable
         WallBlocked,    // Wall that is not removable
+        Solution,       // Path between the exits, drawn over the maze
     };
+    static constexpr int STYLE_COUNT = 6;
 
     virtual ~IPainter() = default;
     virtual void BeginDraw(int width, int height) = 0;
     virtual void EndDraw() = 0;
     virtual void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) = 0;
     virtual void DrawPoly(const std::vector<Point2D>& vertices, EStyle style) = 0;
+    // Open line through `vertices`, drawn as its segments unless the painter has a better element for it
+    virtual void DrawPolyline(const std::vector<Point2D>& vertices, EStyle style) {
+        for (size_t k = 1; k < vertices.size(); k++) {
+            DrawLine(vertices[k - 1], vertices[k], style);
+        }
+    }
 };
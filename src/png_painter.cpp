@@ -0,0 +1,431 @@
+#include "png_painter.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+
+using namespace std;
+
+// Colors of the styles, the same as in svgStyle()
+static constexpr uint8_t STYLE_RGB[IPainter::STYLE_COUNT][3] = {
+    {169, 169, 169}, // OpenCell: darkgray
+    {255, 255, 255}, // VisitedCell: white
+    {211, 211, 211}, // OnPathCell: lightgray
+    {0, 0, 0},       // Wall: black
+    {255, 0, 0},     // WallBlocked: red
+    {0, 0, 255},     // Solution: blue
+};
+
+PngPainter::PngPainter(const PainterParams& params, EPixelFormat format, bool antialias)
+    : format_(format)
+    , antialias_(antialias)
+    , stroke_radius_(params.stroke_width / 2.0) {
+    for (int style = 0; style < STYLE_COUNT; style++) {
+        const auto* rgb = STYLE_RGB[style];
+        if (format == EPixelFormat::Gray) {
+            colors_[style][0] = static_cast<uint8_t>(lround(0.299*rgb[0] + 0.587*rgb[1] + 0.114*rgb[2]));
+        } else {
+            colors_[style][0] = rgb[0];
+            colors_[style][1] = rgb[1];
+            colors_[style][2] = rgb[2];
+            colors_[style][3] = 255;
+        }
+    }
+}
+
+void PngPainter::BeginDraw(int width, int height) {
+    width_ = max(width, 0);
+    height_ = max(height, 0);
+    pixels_.assign(static_cast<size_t>(width_) * height_ * bytesPerPixel(), 255);
+    coverage_.assign(width_, 0.0f);
+}
+
+// Appends the x of the crossings of the edge from `a` to `b` with the sample line at y. An edge covers
+// its lower end but not its upper one, so a shared vertex is crossed once.
+static void addCrossing(double ax, double ay, double bx, double by, double y, vector<double>& xs) {
+    if ((ay <= y) != (by <= y)) {
+        xs.push_back(ax + (y - ay) * (bx - ax) / (by - ay));
+    }
+}
+
+void PngPainter::DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) {
+    // The points within the stroke radius of the segment: two discs and the rectangle between them
+    const auto r = stroke_radius_;
+    const auto length = hypot(p2.x - p1.x, p2.y - p1.y);
+    const auto nx = length > 0 ? -(p2.y - p1.y) / length * r : 0.0;
+    const auto ny = length > 0 ? (p2.x - p1.x) / length * r : 0.0;
+    const double corners[4][2] = {{p1.x + nx, p1.y + ny}, {p2.x + nx, p2.y + ny},
+                                  {p2.x - nx, p2.y - ny}, {p1.x - nx, p1.y - ny}};
+    fill(min(p1.y, p2.y) - r, max(p1.y, p2.y) + r, style, [&](double y, vector<Span>& spans) {
+        // The shape is convex, its spans are a single one
+        auto x1 = HUGE_VAL;
+        auto x2 = -HUGE_VAL;
+        for (const auto& c : {p1, p2}) {
+            const auto dy = y - c.y;
+            if (fabs(dy) <= r) {
+                const auto half = sqrt(r*r - dy*dy);
+                x1 = min(x1, c.x - half);
+                x2 = max(x2, c.x + half);
+            }
+        }
+        if (length > 0) {
+            xs_.clear();
+            for (int k = 0; k < 4; k++) {
+                const auto& a = corners[k];
+                const auto& b = corners[(k + 1) % 4];
+                addCrossing(a[0], a[1], b[0], b[1], y, xs_);
+            }
+            for (const auto x : xs_) {
+                x1 = min(x1, x);
+                x2 = max(x2, x);
+            }
+        }
+        if (x1 < x2) {
+            spans.push_back({x1, x2});
+        }
+    });
+}
+
+void PngPainter::DrawPoly(const vector<Point2D>& vertices, EStyle style) {
+    if (vertices.size() < 3) {
+        return;
+    }
+    auto y1 = vertices[0].y;
+    auto y2 = vertices[0].y;
+    for (const auto& v : vertices) {
+        y1 = min(y1, v.y);
+        y2 = max(y2, v.y);
+    }
+    // Even-odd rule: the spans are between consecutive pairs of crossings
+    fill(y1, y2, style, [&](double y, vector<Span>& spans) {
+        xs_.clear();
+        for (size_t k = 0; k < vertices.size(); k++) {
+            const auto& a = vertices[k];
+            const auto& b = vertices[(k + 1) % vertices.size()];
+            addCrossing(a.x, a.y, b.x, b.y, y, xs_);
+        }
+        sort(xs_.begin(), xs_.end());
+        for (size_t k = 0; k + 1 < xs_.size(); k += 2) {
+            spans.push_back({xs_[k], xs_[k + 1]});
+        }
+    });
+}
+
+template< typename Spans >
+void PngPainter::fill(double y1, double y2, EStyle style, Spans spans) {
+    const auto* color = colors_[static_cast<int>(style)];
+    const auto row1 = max(0, static_cast<int>(floor(y1)));
+    const auto row2 = min(height_, static_cast<int>(ceil(y2)));
+    for (int y = row1; y < row2; y++) {
+        if (!antialias_) {
+            // The pixels whose center is in a span
+            spans_.clear();
+            spans(y + 0.5, spans_);
+            for (const auto& span : spans_) {
+                const auto x1 = max(0.0, ceil(span.x1 - 0.5));
+                const auto x2 = min(static_cast<double>(width_), ceil(span.x2 - 0.5));
+                if (x1 < x2) {
+                    fillSpan(y, static_cast<int>(x1), static_cast<int>(x2), color);
+                }
+            }
+            continue;
+        }
+
+        // Coverage of the pixels: the length of the spans in each of them, on every sample line
+        auto min_x = width_;
+        auto max_x = 0;
+        for (int k = 0; k < SUBSAMPLES; k++) {
+            spans_.clear();
+            spans(y + (k + 0.5) / SUBSAMPLES, spans_);
+            for (const auto& span : spans_) {
+                const auto x1 = max(span.x1, 0.0);
+                const auto x2 = min(span.x2, static_cast<double>(width_));
+                if (x1 >= x2) {
+                    continue;
+                }
+                const auto first = static_cast<int>(x1);
+                const auto last = min(static_cast<int>(ceil(x2)) - 1, width_ - 1);
+                if (first == last) {
+                    coverage_[first] += static_cast<float>((x2 - x1) / SUBSAMPLES);
+                } else {
+                    coverage_[first] += static_cast<float>((first + 1 - x1) / SUBSAMPLES);
+                    for (int x = first + 1; x < last; x++) {
+                        coverage_[x] += 1.0f / SUBSAMPLES;
+                    }
+                    coverage_[last] += static_cast<float>((x2 - last) / SUBSAMPLES);
+                }
+                min_x = min(min_x, first);
+                max_x = max(max_x, last + 1);
+            }
+        }
+
+        // Runs of covered pixels are filled, the partly covered ones are blended
+        constexpr auto COVERED = 0.999f;
+        for (int x = min_x; x < max_x;) {
+            if (coverage_[x] >= COVERED) {
+                auto end = x + 1;
+                while (end < max_x && coverage_[end] >= COVERED) {
+                    end++;
+                }
+                fillSpan(y, x, end, color);
+                fill_n(coverage_.begin() + x, end - x, 0.0f);
+                x = end;
+            } else {
+                if (coverage_[x] > 0) {
+                    blend(y, x, coverage_[x], color);
+                    coverage_[x] = 0;
+                }
+                x++;
+            }
+        }
+    }
+}
+
+void PngPainter::fillSpan(int y, int x1, int x2, const uint8_t* color) {
+    const auto bpp = static_cast<size_t>(bytesPerPixel());
+    auto* p = &pixels_[(static_cast<size_t>(y) * width_ + x1) * bpp];
+    const auto size = static_cast<size_t>(x2 - x1) * bpp;
+    if (bpp == 1) {
+        memset(p, color[0], size);
+        return;
+    }
+    // The filled part is copied over the rest, doubling it each time
+    memcpy(p, color, bpp);
+    for (size_t filled = bpp; filled < size; filled *= 2) {
+        memcpy(p + filled, p, min(filled, size - filled));
+    }
+}
+
+void PngPainter::blend(int y, int x, double coverage, const uint8_t* color) {
+    const auto bpp = bytesPerPixel();
+    auto* p = &pixels_[(static_cast<size_t>(y) * width_ + x) * bpp];
+    const auto a = min(coverage, 1.0);
+    // The alpha of RGBA stays opaque
+    for (int c = 0; c < (bpp == 1 ? 1 : 3); c++) {
+        p[c] = static_cast<uint8_t>(lround(p[c] + (color[c] - p[c]) * a));
+    }
+}
+
+// ----------- PNG encoding -----------
+
+static const array<uint32_t, 256>& crcTable() {
+    static const auto table = [] {
+        array<uint32_t, 256> t;
+        for (uint32_t n = 0; n < 256; n++) {
+            auto c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    const auto& table = crcTable();
+    for (size_t k = 0; k < size; k++) {
+        crc = table[(crc ^ data[k]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint32_t adler32(const vector<uint8_t>& data) {
+    // Largest block whose sums cannot overflow before the modulo
+    constexpr size_t BLOCK = 5552;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t start = 0; start < data.size(); start += BLOCK) {
+        const auto end = min(start + BLOCK, data.size());
+        for (auto k = start; k < end; k++) {
+            a += data[k];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
+
+static void appendBigEndian(vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+// Bits of a deflate stream, from the least significant bit of each byte
+class BitWriter
+{
+public:
+    explicit BitWriter(vector<uint8_t>& out): out_(out) {}
+
+    void write(uint32_t value, int count) {
+        bits_ |= value << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            out_.push_back(static_cast<uint8_t>(bits_));
+            bits_ >>= 8;
+            count_ -= 8;
+        }
+    }
+    // Huffman codes are written from their most significant bit
+    void writeCode(uint32_t code, int count) {
+        uint32_t reversed = 0;
+        for (int k = 0; k < count; k++) {
+            reversed = reversed << 1 | (code >> k & 1);
+        }
+        write(reversed, count);
+    }
+    void flush() {
+        if (count_ > 0) {
+            out_.push_back(static_cast<uint8_t>(bits_));
+        }
+        bits_ = 0;
+        count_ = 0;
+    }
+
+private:
+    vector<uint8_t>& out_;
+    uint32_t bits_ = 0;
+    int count_ = 0;
+};
+
+static constexpr int MIN_MATCH = 3;
+static constexpr int MAX_MATCH = 258;
+static constexpr size_t MAX_DISTANCE = 32768;
+static constexpr int LENGTH_BASE[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+                                      99, 115, 131, 163, 195, 227, 258};
+static constexpr int LENGTH_EXTRA[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5,
+                                       5, 0};
+static constexpr int DISTANCE_BASE[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static constexpr int DISTANCE_EXTRA[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11,
+                                         11, 12, 12, 13, 13};
+
+// Literal or length symbol with the fixed Huffman codes
+static void writeSymbol(BitWriter& w, int symbol) {
+    if (symbol < 144) {
+        w.writeCode(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        w.writeCode(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        w.writeCode(symbol - 256, 7);
+    } else {
+        w.writeCode(0xc0 + symbol - 280, 8);
+    }
+}
+
+static void writeMatch(BitWriter& w, int length, int distance) {
+    auto code = static_cast<int>(size(LENGTH_BASE)) - 1;
+    while (LENGTH_BASE[code] > length) {
+        code--;
+    }
+    writeSymbol(w, 257 + code);
+    w.write(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = static_cast<int>(size(DISTANCE_BASE)) - 1;
+    while (DISTANCE_BASE[code] > distance) {
+        code--;
+    }
+    w.writeCode(code, 5);
+    w.write(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+// zlib stream of `data` in a single block with the fixed Huffman codes
+//
+// The repeats looked for are at the distances in `distances` (the previous pixel and the previous row of
+// the image) and at the last position with the same next 3 bytes (found by a hash table, this finds the
+// repeated cells along a row), the longest one is taken.
+static vector<uint8_t> deflate(const vector<uint8_t>& data, vector<size_t> distances) {
+    constexpr int HASH_BITS = 15;
+    vector<uint8_t> out = {0x78, 0x01};
+    BitWriter w(out);
+    // Last block, fixed Huffman codes
+    w.write(1, 1);
+    w.write(1, 2);
+    // Last position + 1 of each hash of 3 bytes, 0 for none
+    vector<size_t> last_positions(size_t(1) << HASH_BITS, 0);
+    const auto hash = [&data](size_t k) {
+        const auto bytes = static_cast<uint32_t>(data[k]) << 16 | data[k + 1] << 8 | data[k + 2];
+        return (bytes * 2654435761u) >> (32 - HASH_BITS);
+    };
+    const auto fixed_count = distances.size();
+    for (size_t k = 0; k < data.size();) {
+        const auto max_length = static_cast<int>(min(static_cast<size_t>(MAX_MATCH), data.size() - k));
+        distances.resize(fixed_count);
+        if (max_length >= MIN_MATCH) {
+            const auto last = last_positions[hash(k)];
+            if (last > 0) {
+                distances.push_back(k + 1 - last);
+            }
+        }
+        auto best_length = 0;
+        size_t best_distance = 0;
+        for (const auto distance : distances) {
+            if (distance > k || distance > MAX_DISTANCE) {
+                continue;
+            }
+            auto length = 0;
+            while (length < max_length && data[k + length] == data[k + length - distance]) {
+                length++;
+            }
+            if (length > best_length) {
+                best_length = length;
+                best_distance = distance;
+            }
+        }
+        const auto length = best_length >= MIN_MATCH ? best_length : 1;
+        if (length > 1) {
+            writeMatch(w, best_length, static_cast<int>(best_distance));
+        } else {
+            writeSymbol(w, data[k]);
+        }
+        for (const auto end = k + length; k < end; k++) {
+            if (k + MIN_MATCH <= data.size()) {
+                last_positions[hash(k)] = k + 1;
+            }
+        }
+    }
+    writeSymbol(w, 256);
+    w.flush();
+    appendBigEndian(out, adler32(data));
+    return out;
+}
+
+static void writeChunk(ostream& os, const char* type, const vector<uint8_t>& data) {
+    vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    const auto crc = crc32(0xffffffffu, chunk.data() + 4, chunk.size() - 4) ^ 0xffffffffu;
+    appendBigEndian(chunk, crc);
+    os.write(reinterpret_cast<const char*>(chunk.data()), static_cast<streamsize>(chunk.size()));
+}
+
+void PngPainter::Write(ostream& os) const {
+    static constexpr uint8_t SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    os.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+    vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(width_));
+    appendBigEndian(header, static_cast<uint32_t>(height_));
+    // Bit depth, color type (grayscale or RGBA), compression, filter and interlace methods
+    header.insert(header.end(), {8, static_cast<uint8_t>(format_ == EPixelFormat::Gray ? 0 : 6), 0, 0, 0});
+    writeChunk(os, "IHDR", header);
+
+    // Rows without filtering: a 0 before each of them
+    const auto row_size = static_cast<size_t>(width_) * bytesPerPixel();
+    vector<uint8_t> rows;
+    rows.reserve((row_size + 1) * height_);
+    for (int y = 0; y < height_; y++) {
+        rows.push_back(0);
+        const auto* row = pixels_.data() + y * row_size;
+        rows.insert(rows.end(), row, row + row_size);
+    }
+    writeChunk(os, "IDAT", deflate(rows, {static_cast<size_t>(bytesPerPixel()), row_size + 1}));
+    writeChunk(os, "IEND", {});
+}
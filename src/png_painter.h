@@ -0,0 +1,75 @@
+#pragma once
+
+#include "painter.h"
+#include "svg_painter.h"
+
+#include <stdint.h>
+
+#include <ostream>
+#include <vector>
+
+enum class EPixelFormat
+{
+    Gray, // 8-bit grayscale
+    Rgba, // 8 bits per channel, opaque
+};
+
+// Painter rasterizing the maze into a pixel buffer, written as a PNG image (see Write)
+//
+// The image is white before the first element. Polygons and lines (with round caps, PainterParams'
+// stroke width) are cut into horizontal spans on each row, an opaque span is filled with a memset-like
+// copy. With anti-aliasing each row is sampled on 4 lines with exact horizontal coverage, and the edge
+// pixels are blended. The PNG is compressed by its own deflate encoder (fixed Huffman codes, repeats of
+// the previous pixel, of the previous row and of the last same 3 bytes), so no image library is needed.
+class PngPainter : public IPainter
+{
+public:
+    PngPainter(const PainterParams& params, EPixelFormat format, bool antialias);
+
+    PngPainter(const PngPainter&) = delete;
+    PngPainter& operator=(const PngPainter&) = delete;
+
+    void BeginDraw(int width, int height) override;
+    void EndDraw() override {}
+    void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) override;
+    void DrawPoly(const std::vector<Point2D>& vertices, EStyle style) override;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int bytesPerPixel() const { return format_ == EPixelFormat::Gray ? 1 : 4; }
+    // The bytes of the pixel at column x and row y (gray, or red, green, blue and alpha)
+    const uint8_t* pixel(int x, int y) const { return &pixels_[(static_cast<size_t>(y) * width_ + x) * bytesPerPixel()]; }
+
+    void Write(std::ostream& os) const;
+
+private:
+    // Samples per row with anti-aliasing
+    static constexpr int SUBSAMPLES = 4;
+
+    // A horizontal span [x1, x2) on the sample line at some y
+    struct Span
+    {
+        double x1;
+        double x2;
+    };
+
+    // Fills the shape whose spans on the sample line at y are appended by `spans(y, out)`, within rows
+    // [y1, y2)
+    template< typename Spans >
+    void fill(double y1, double y2, EStyle style, Spans spans);
+    void fillSpan(int y, int x1, int x2, const uint8_t* color);
+    void blend(int y, int x, double coverage, const uint8_t* color);
+
+    const EPixelFormat format_;
+    const bool antialias_;
+    const double stroke_radius_;
+    // Bytes of a pixel of each style
+    uint8_t colors_[STYLE_COUNT][4];
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<uint8_t> pixels_;
+    // Spans of a sample line, and coverage of the pixels of a row with anti-aliasing
+    std::vector<Span> spans_;
+    std::vector<double> xs_;
+    std::vector<float> coverage_;
+};
@@ -0,0 +1,148 @@
+#include "polyline_painter.h"
+
+#include <stdint.h>
+
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+uint64_t pointKey(const Point2D& p) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32 | static_cast<uint32_t>(p.y);
+}
+
+bool operator==(const Point2D& lhs, const Point2D& rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+// Whether a line going from `a` to `b` goes straight on to `c`
+bool isStraight(const Point2D& a, const Point2D& b, const Point2D& c) {
+    const auto dx1 = static_cast<long long>(b.x) - a.x;
+    const auto dy1 = static_cast<long long>(b.y) - a.y;
+    const auto dx2 = static_cast<long long>(c.x) - b.x;
+    const auto dy2 = static_cast<long long>(c.y) - b.y;
+    return dx1*dy2 == dy1*dx2 && dx1*dx2 + dy1*dy2 > 0;
+}
+
+} // namespace
+
+vector<vector<Point2D>> mergeSegments(const vector<Segment>& segments) {
+    vector<vector<Point2D>> polylines;
+
+    // The ends of the segments are the vertices of a graph, ends[2*k] and ends[2*k + 1] are those of segment k
+    unordered_map<uint64_t, int> vertex_ids;
+    vertex_ids.reserve(segments.size());
+    vector<Point2D> vertices;
+    vector<int> degrees;
+    vector<int> ends(2 * segments.size(), -1);
+    for (size_t k = 0; k < segments.size(); k++) {
+        const auto& segment = segments[k];
+        if (segment.p1 == segment.p2) {
+            polylines.push_back({segment.p1, segment.p2});
+            continue;
+        }
+        for (size_t e = 0; e < 2; e++) {
+            const auto& p = e == 0 ? segment.p1 : segment.p2;
+            const auto [it, inserted] = vertex_ids.try_emplace(pointKey(p), static_cast<int>(vertices.size()));
+            if (inserted) {
+                vertices.push_back(p);
+                degrees.push_back(0);
+            }
+            ends[2*k + e] = it->second;
+            degrees[it->second]++;
+        }
+    }
+
+    // Segments at each vertex v: incident[first[v]] to incident[first[v + 1] - 1]. first[v] is moved past the
+    // segments already in a polyline, they are never needed again.
+    vector<int> first(vertices.size() + 1, 0);
+    for (size_t v = 0; v < vertices.size(); v++) {
+        first[v + 1] = first[v] + degrees[v];
+    }
+    vector<int> incident(first.back());
+    vector<int> fill(first.begin(), first.end() - 1);
+    for (size_t k = 0; k < segments.size(); k++) {
+        if (ends[2*k] >= 0) {
+            incident[fill[ends[2*k]]++] = static_cast<int>(k);
+            incident[fill[ends[2*k + 1]]++] = static_cast<int>(k);
+        }
+    }
+    vector<bool> used(segments.size(), false);
+    const auto hasUnused = [&](int v) {
+        while (first[v] < first[v + 1] && used[incident[first[v]]]) {
+            first[v]++;
+        }
+        return first[v] < first[v + 1];
+    };
+    const auto otherEnd = [&](int segment, int v) {
+        return ends[2*segment] == v ? ends[2*segment + 1] : ends[2*segment];
+    };
+
+    // Follows unused segments from `v` until there is none, straight on where possible
+    const auto walk = [&](int v) {
+        vector<Point2D> polyline = {vertices[v]};
+        while (hasUnused(v)) {
+            auto next = incident[first[v]];
+            if (polyline.size() > 1) {
+                for (auto k = first[v] + 1; k < first[v + 1]; k++) {
+                    const auto segment = incident[k];
+                    if (!used[segment] && isStraight(polyline[polyline.size() - 2], vertices[v],
+                                                     vertices[otherEnd(segment, v)])) {
+                        next = segment;
+                        break;
+                    }
+                }
+            }
+            used[next] = true;
+            v = otherEnd(next, v);
+            if (polyline.size() > 1 && isStraight(polyline[polyline.size() - 2], polyline.back(), vertices[v])) {
+                polyline.back() = vertices[v];
+            } else {
+                polyline.push_back(vertices[v]);
+            }
+        }
+        polylines.push_back(move(polyline));
+    };
+
+    // Polylines start at the vertices of odd degree, what remains after them are cycles
+    for (size_t v = 0; v < vertices.size(); v++) {
+        if (degrees[v] % 2 != 0) {
+            while (hasUnused(static_cast<int>(v))) {
+                walk(static_cast<int>(v));
+            }
+        }
+    }
+    for (size_t v = 0; v < vertices.size(); v++) {
+        while (hasUnused(static_cast<int>(v))) {
+            walk(static_cast<int>(v));
+        }
+    }
+    return polylines;
+}
+
+void PolylinePainter::BeginDraw(int width, int height) {
+    for (auto& lines : lines_) {
+        lines.clear();
+    }
+    painter_.BeginDraw(width, height);
+}
+
+void PolylinePainter::EndDraw() {
+    for (int style = 0; style < STYLE_COUNT; style++) {
+        for (const auto& polyline : mergeSegments(lines_[style])) {
+            painter_.DrawPolyline(polyline, static_cast<EStyle>(style));
+        }
+        lines_[style].clear();
+    }
+    painter_.EndDraw();
+}
+
+void PolylinePainter::DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) {
+    lines_[static_cast<int>(style)].push_back({p1, p2});
+}
+
+void PolylinePainter::DrawPoly(const vector<Point2D>& vertices, EStyle style) {
+    painter_.DrawPoly(vertices, style);
+}
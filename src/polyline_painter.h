@@ -0,0 +1,41 @@
+#pragma once
+
+#include "painter.h"
+
+#include <vector>
+
+struct Segment
+{
+    Point2D p1;
+    Point2D p2;
+};
+
+// Joins segments sharing their ends into polylines, each segment is in exactly one of them
+//
+// A polyline goes straight on through a vertex whenever it can, and collinear segments are merged: the
+// vertices of a polyline are its ends and its turns only. Zero-length segments are polylines of their own.
+std::vector<std::vector<Point2D>> mergeSegments(const std::vector<Segment>& segments);
+
+// Painter drawing into another painter with the lines of each style merged into polylines
+//
+// The cells are drawn as they come, the lines are collected and drawn at EndDraw (see mergeSegments), so
+// they are drawn over all the cells, the styles in EStyle order. A wall of a grid is a line between two
+// cells, so the walls of a maze become a few long polylines and the output is several times smaller.
+class PolylinePainter : public IPainter
+{
+public:
+    explicit PolylinePainter(IPainter& painter): painter_(painter) {}
+
+    PolylinePainter(const PolylinePainter&) = delete;
+    PolylinePainter& operator=(const PolylinePainter&) = delete;
+
+    void BeginDraw(int width, int height) override;
+    void EndDraw() override;
+    void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) override;
+    void DrawPoly(const std::vector<Point2D>& vertices, EStyle style) override;
+
+private:
+    IPainter& painter_;
+    // Lines drawn since BeginDraw, by style
+    std::vector<Segment> lines_[STYLE_COUNT];
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <iterator>
+#include <utility>
+
+// Random numbers that are the same on every platform
+//
+// The engines of <random> are fully specified by the standard, but the distributions (and std::shuffle)
+// are not: the same seed gives different results with libstdc++, libc++ and MSVC. Everything in this file
+// uses fixed-width integer arithmetic only, so the sequences depend on nothing but the seed.
+
+// PCG32 (XSH RR variant), a small and fast generator with 32-bit output
+// https://www.pcg-random.org/
+//
+// Satisfies UniformRandomBitGenerator. The output is identical to pcg32_srandom_r() of the reference
+// implementation for the same seed and stream.
+class Pcg32
+{
+public:
+    using result_type = uint32_t;
+
+    // Generators with the same seed but different streams give independent sequences
+    explicit Pcg32(uint64_t seed, uint64_t stream = DEFAULT_STREAM)
+        : state_(0)
+        , inc_((stream << 1) | 1)
+    {
+        (*this)();
+        state_ += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()() {
+        const auto old_state = state_;
+        state_ = old_state * MULTIPLIER + inc_;
+        const auto xorshifted = static_cast<uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+        const auto rot = static_cast<uint32_t>(old_state >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+    }
+
+private:
+    static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+    static constexpr uint64_t DEFAULT_STREAM = 1442695040888963407ULL >> 1;
+
+    uint64_t state_;
+    uint64_t inc_;
+};
+
+// Uniform random integer in [0, n) from an engine with 32-bit output (e.g. Pcg32 or std::mt19937)
+//
+// Lemire's multiply-and-shift mapping: no division in the common case, and rejection of the few values
+// that would make the result biased.
+// https://arxiv.org/abs/1805.10941
+template< typename RandomEngine >
+uint32_t randomBelow(RandomEngine& engine, uint32_t n) {
+    static_assert(RandomEngine::min() == 0 && RandomEngine::max() == UINT32_MAX,
+                  "randomBelow() requires an engine with 32-bit output");
+    auto m = static_cast<uint64_t>(engine()) * n;
+    auto low = static_cast<uint32_t>(m);
+    if (low < n) {
+        const auto threshold = (0u - n) % n;   // 2^32 mod n
+        while (low < threshold) {
+            m = static_cast<uint64_t>(engine()) * n;
+            low = static_cast<uint32_t>(m);
+        }
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
+
+// Fisher-Yates shuffle, a portable replacement of std::shuffle
+template< typename RandomIt, typename RandomEngine >
+void randomShuffle(RandomIt first, RandomIt last, RandomEngine& engine) {
+    const auto size = std::distance(first, last);
+    for (auto i = size - 1; i > 0; i--) {
+        const auto j = randomBelow(engine, static_cast<uint32_t>(i + 1));
+        using std::swap;
+        swap(first[i], first[j]);
+    }
+}
@@ -1,6 +1,14 @@
 #include "square_maze.h"
+#include "create_maze.h"
+#include "gen_region.h"
+#include "grid_topology.h"
+#include "maze_journal.h"
+#include "maze_solver.h"
 #include "svg_painter.h"
 
+#include <algorithm>
+#include <bit>
+
 using namespace std;
 
 using EStyle = IPainter::EStyle;
@@ -8,16 +16,36 @@ using EStyle = IPainter::EStyle;
 static constexpr auto NODE_OPEN = static_cast<int>(ENode::Open);
 static constexpr auto NODE_VISITED = static_cast<int>(ENode::Visited);
 static constexpr auto NODE_ONPATH = static_cast<int>(ENode::OnPath);
-static constexpr auto NODE_INVALID = -1;
+static constexpr auto NODE_INVALID = static_cast<int>(ENode::Invalid);
 
 static constexpr auto EDGE_OPEN = static_cast<int>(EEdge::Open);
 static constexpr auto EDGE_ONPATH = static_cast<int>(EEdge::OnPath);
-static constexpr auto EDGE_INVALID = -1;
+static constexpr auto EDGE_INVALID = 3; // The states are stored in 2 bits
+
+// Edge slots and neighbours of SquareMaze. Edge directions: 1 S, 2 E, 3 N, 4 W
+static constexpr GridTopology<4, 1> TOPOLOGY = {
+    EGridParity::None,
+    2,
+    {
+        {{0, 0}, {1, 2}, {1, 3}, {0, 2}, {1, 1}},
+    },
+    {
+        {{0, 0}, {1, 0}, {0, 1}, {-1, 0}, {0, -1}},
+    },
+};
+static_assert(TOPOLOGY.isConsistent());
 
-#define E1(i, j)    (edges_[i+1][2*j + 2])                                      // direction S
-#define E2(i, j)    (edges_[i+1][2*j + 3])                                      // direction E
-#define E3(i, j)    (edges_[i][2*j + 2])                                        // direction N
-#define E4(i, j)    (edges_[i+1][2*j + 1])                                      // direction W
+inline int SquareMaze::edgeState(int i, int j, EdgeIndex edge) const {
+    const auto slot = TOPOLOGY.edgeSlot(i, j, edge);
+    return edges_[slot.row][slot.col];
+}
+
+void SquareMaze::setEdgeState(int i, int j, EdgeIndex edge, int state) {
+    const auto slot = TOPOLOGY.edgeSlot(i, j, edge);
+    auto state_ref = edges_[slot.row][slot.col];
+    open_edge_masks_.update(TOPOLOGY, i, j, edge, state_ref, state);
+    state_ref = state;
+}
 
 struct PointParams
 {
@@ -36,10 +64,22 @@ SquareMaze::SquareMaze(int rows, int cols)
     , cols_(cols)
     , nodes_(rows, cols)
     , edges_(rows+1, 2*(cols+2))
+    , open_nodes_(rows*cols)
+    , open_edge_masks_(rows, cols)
 {
     invalidateRegionEdges({0, 0}, {rows-1, cols-1});
 }
 
+SquareMaze::~SquareMaze() = default;
+
+void SquareMaze::Reset() {
+    nodes_.clear();
+    edges_.clear();
+    open_nodes_.reset();
+    open_edge_masks_.reset();
+    invalidateRegionEdges({0, 0}, {rows_-1, cols_-1});
+}
+
 inline static bool isEdgeVisible(int edge) {
     return edge == EDGE_OPEN || edge == EDGE_INVALID;
 }
@@ -84,6 +124,10 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
     // Cells
     for (int i = 0; i < rows_; i++) {
         for (int j = 0; j < cols_; j++) {
+            const auto style = nodeStyle(nodes_[i][j]);
+            if (!p.isCellDrawn(style)) {
+                continue;
+            }
             const auto c = nodeCenter({i, j}, cell_width, cell_height, padding_x, padding_y);
             const auto p = PointParams{c, cell_width, cell_height};
             const auto p1{P1(p)};
@@ -91,7 +135,7 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p3{P3(p)};
             const auto p4{P4(p)};
 
-            painter.DrawPoly({p4, p3, p2, p1}, nodeStyle(nodes_[i][j]));
+            painter.DrawPoly({p4, p3, p2, p1}, style);
         }
     }
 
@@ -103,7 +147,7 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p1{P1(p)};
         const auto p4{P4(p)};
 
-        const char e4 = E4(i, j);
+        const char e4 = edgeState(i, j, 4);
         if (isEdgeVisible(e4)) {
             painter.DrawLine(p4, p1, edgeStyle(e4));
         }
@@ -117,7 +161,7 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
         const auto p3{P3(p)};
         const auto p4{P4(p)};
 
-        const char e3 = E3(i, j);
+        const char e3 = edgeState(i, j, 3);
         if (isEdgeVisible(e3)) {
             painter.DrawLine(p3, p4, edgeStyle(e3));
         }
@@ -136,8 +180,8 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p2{P2(p)};
             const auto p3{P3(p)};
 
-            const char e1 = E1(i, j);
-            const char e2 = E2(i, j);
+            const char e1 = edgeState(i, j, 1);
+            const char e2 = edgeState(i, j, 2);
             if (isEdgeVisible(e1)) {
                 painter.DrawLine(p1, p2, edgeStyle(e1));
             }
@@ -169,8 +213,8 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
             const auto p2{P2(p)};
             const auto p3{P3(p)};
 
-            const char e1 = E1(i, j);
-            const char e2 = E2(i, j);
+            const char e1 = edgeState(i, j, 1);
+            const char e2 = edgeState(i, j, 2);
             if (b1 && isEdgeVisible(e1)) {
                 painter.DrawLine(p1, p2, edgeStyle(e1));
             }
@@ -180,6 +224,20 @@ void SquareMaze::Draw(IPainter& painter, const DrawParams& p) const {
         }
     }
 
+    // Solution, through the middle of the cells
+    if (p.show_solution) {
+        MazeSolver<SquareMaze> solver;
+        vector<NodeIndex> path;
+        if (solver.solve(*this, path)) {
+            const auto middle = [&](NodeIndex node) {
+                const auto c = nodeCenter(node, cell_width, cell_height, padding_x, padding_y);
+                return Point2D{c.x + cell_width/2, c.y + cell_height/2};
+            };
+            for (size_t k = 1; k < path.size(); k++) {
+                painter.DrawLine(middle(path[k - 1]), middle(path[k]), EStyle::Solution);
+            }
+        }
+    }
 
     painter.EndDraw();
 }
@@ -190,61 +248,42 @@ ENode SquareMaze::getNode(NodeIndex node) const {
 
 void SquareMaze::setNode(NodeIndex node, ENode val) {
     nodes_[node.i][node.j] = static_cast<int>(val);
+    if (val == ENode::Open) {
+        open_nodes_.insert(nodeId(node));
+    } else {
+        open_nodes_.erase(nodeId(node));
+    }
 }
 
 void SquareMaze::getOpenEdges(NodeIndex node, EdgeList& edges) const {
-    const auto i = node.i;
-    const auto j = node.j;
-    const auto e1 = E1(i, j);
-    const auto e2 = E2(i, j);
-    const auto e3 = E3(i, j);
-    const auto e4 = E4(i, j);
-
     edges.clear();
-    if (e1 == EDGE_OPEN || e1 == EDGE_ONPATH) edges.push_back(1);
-    if (e2 == EDGE_OPEN || e2 == EDGE_ONPATH) edges.push_back(2);
-    if (e3 == EDGE_OPEN || e3 == EDGE_ONPATH) edges.push_back(3);
-    if (e4 == EDGE_OPEN || e4 == EDGE_ONPATH) edges.push_back(4);
+    for (auto mask = getOpenEdgeMask(node); mask != 0; mask &= mask - 1) {
+        edges.push_back(std::countr_zero(mask));
+    }
 }
 
 void SquareMaze::setEdge(NodeIndex node, EdgeIndex edge, EEdge val) {
     const auto i = node.i;
     const auto j = node.j;
     const auto intval = static_cast<int>(val);
-    switch (edge) {
-        case 1: E1(i, j) = intval; break;
-        case 2: E2(i, j) = intval; break;
-        case 3: E3(i, j) = intval; break;
-        case 4: E4(i, j) = intval; break;
-        default:
-            assert(0);
-    }
+    assert(1 <= edge && edge <= 4);
+    setEdgeState(i, j, edge, intval);
 }
 
 EEdge SquareMaze::getEdge(NodeIndex node, EdgeIndex edge) const {
     const auto i = node.i;
     const auto j = node.j;
-    int intval = 0;
-    switch (edge) {
-        case 1: intval = E1(i, j); break;
-        case 2: intval = E2(i, j); break;
-        case 3: intval = E3(i, j); break;
-        case 4: intval = E4(i, j); break;
-        default:
-            assert(0);
-    }
+    assert(1 <= edge && edge <= 4);
+    const auto intval = edgeState(i, j, edge);
     return static_cast<EEdge>(intval);
 }
 
 SquareMaze::NodeIndex SquareMaze::getOpenNode() const {
-    for (int i = 0; i < nodes_.rows(); i++) {
-        for (int j = 0; j < nodes_.cols(); j++) {
-            if (nodes_[i][j] == EDGE_OPEN) {
-                return {i, j};
-            }
-        }
+    const auto id = open_nodes_.first();
+    if (id < 0) {
+        return invalidNode();
     }
-    return invalidNode();
+    return nodeFromId(id);
 }
 
 bool SquareMaze::nodeExists(NodeIndex node) const {
@@ -253,16 +292,10 @@ bool SquareMaze::nodeExists(NodeIndex node) const {
 }
 
 SquareMaze::NodeIndex SquareMaze::nextNode(NodeIndex node, EdgeIndex edge) {
-    const auto i = node.i;
-    const auto j = node.j;
-    switch (edge) {
-        case 1: return {i+1, j};
-        case 2: return {i, j+1};
-        case 3: return {i-1, j};
-        case 4: return {i, j-1};
+    if (edge < 1 || edge > 4) {
+        return invalidNode();
     }
-    return invalidNode();
-
+    return TOPOLOGY.nextNode(node.i, node.j, edge);
 }
 
 SquareMaze::NodeIndex SquareMaze::invalidNode() {
@@ -277,12 +310,12 @@ void SquareMaze::invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight)
         {
             // Left vertical line
             const auto j = topLeft.j;
-            E4(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 4, EDGE_INVALID);
         }
         {
             // Right vertical line
             const auto j = bottomRight.j;
-            E2(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 2, EDGE_INVALID);
         }
     }
 
@@ -290,12 +323,12 @@ void SquareMaze::invalidateRegionEdges(NodeIndex topLeft, NodeIndex bottomRight)
         {
             // Top horizontal line
             const auto i = topLeft.i;
-            E3(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 3, EDGE_INVALID);
         }
         {
             // Bottom horizontal line
             const auto i = bottomRight.i;
-            E1(i, j) = EDGE_INVALID;
+            setEdgeState(i, j, 1, EDGE_INVALID);
         }
     }
 }
@@ -306,6 +339,7 @@ void SquareMaze::invalidateRegion(NodeIndex topLeft, NodeIndex bottomRight) {
     for (int i = topLeft.i; i <= bottomRight.i; i++) {
         for (int j = topLeft.j; j <= bottomRight.j; j++) {
             nodes_[i][j] = NODE_INVALID;
+            open_nodes_.erase(nodeId({i, j}));
         }
     }
 }
@@ -325,7 +359,45 @@ void SquareMaze::AddExits() {
     setEdge({rows_ - 1, cols_ - 1}, 1, EEdge::Visited);
 }
 
-ECreateMazeResult SquareMaze::CreateMaze(unsigned random_seed) {
-    CreateMazeWilson<SquareMaze> maze_gen(random_seed);
-    return maze_gen.createMaze(*this);
+void SquareMaze::AddLongestPathExits() {
+    addLongestPathExits(*this);
+}
+
+void SquareMaze::RecordLongestPathExits(MazeJournal& journal) {
+    addLongestPathExits(*this, JournalRecorder<SquareMaze>(journal, *this));
+}
+
+void SquareMaze::SetOpenNodeOrder(EOpenNodeOrder order, unsigned random_seed) {
+    open_nodes_.setOrder(order, random_seed);
+}
+
+ECreateMazeResult SquareMaze::CreateMaze(const CreateMazeParams& params, CreateMazeStats* stats) {
+    if (!generators_) {
+        generators_ = std::make_unique<MazeGenerators<SquareMaze>>();
+    }
+    return generators_->createMaze(*this, params, stats);
+}
+
+ECreateMazeResult SquareMaze::RecordMaze(const CreateMazeParams& params, CreateMazeStats* stats,
+                                         MazeJournal& journal) {
+    return createMaze(*this, params, stats, JournalRecorder<SquareMaze>(journal, *this));
+}
+
+void SquareMaze::DrawAnimation(IPainter& painter, const DrawParams& p, const MazeJournal& journal,
+                               int frame_count) {
+    drawJournalFrames(*this, journal, frame_count, painter, p);
+}
+
+void SquareMaze::RegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                                  CreateMazeStats* stats) {
+    regenerateRegion(*this, top_left, bottom_right, random_seed, stats);
+}
+
+void SquareMaze::RecordRegenerateRegion(NodeIndex top_left, NodeIndex bottom_right, unsigned random_seed,
+                                        CreateMazeStats* stats, MazeJournal& journal) {
+    regenerateRegion(*this, top_left, bottom_right, random_seed, stats, JournalRecorder<SquareMaze>(journal, *this));
+}
+
+MazeMetrics SquareMaze::ComputeMetrics() const {
+    return computeMazeMetrics(*this);
 }
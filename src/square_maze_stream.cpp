@@ -0,0 +1,169 @@
+#include "square_maze_stream.h"
+#include "painter.h"
+
+#include <assert.h>
+
+using namespace std;
+
+using EStyle = IPainter::EStyle;
+
+struct PointParams
+{
+    const Point2D& center;
+    int cell_width;
+    int cell_height;
+};
+
+// Same geometry as SquareMaze
+inline static Point2D P1(const PointParams& p) { return { p.center.x, p.center.y + p.cell_height }; }
+inline static Point2D P2(const PointParams& p) { return { p.center.x + p.cell_width, p.center.y + p.cell_height }; }
+inline static Point2D P3(const PointParams& p) { return { p.center.x + p.cell_width, p.center.y }; }
+inline static Point2D P4(const PointParams& p) { return { p.center.x, p.center.y }; }
+
+inline static Point2D nodeCenter(int i, int j, int cell_width, int cell_height, int padding_x, int padding_y) {
+    const auto x_0 = cell_width*j + padding_x;
+    const auto y_0 = cell_height*i + padding_y;
+    return {x_0, y_0};
+}
+
+SquareMazeStream::SquareMazeStream(int rows, int cols, unsigned random_seed)
+    : rows_(rows)
+    , cols_(cols)
+    , exits_(false)
+    , random_engine_(random_seed)
+    , sets_(cols)
+    , right_open_(cols, 0)
+    , down_open_(cols, 0)
+    , remaining_(cols, 0)
+    , next_root_(cols, -1)
+{
+    assert(rows > 0);
+    assert(cols > 0);
+    // Each cell of the first row is in its own set
+    for (int j = 0; j < cols; j++) {
+        sets_[j] = j;
+    }
+}
+
+void SquareMazeStream::AddExits() {
+    exits_ = true;
+}
+
+int SquareMazeStream::findSet(int j) {
+    // Path splitting: every cell on the path is linked to its grandparent
+    while (sets_[j] != j) {
+        const auto parent = sets_[j];
+        sets_[j] = sets_[parent];
+        j = parent;
+    }
+    return j;
+}
+
+void SquareMazeStream::unionSets(int j1, int j2) {
+    sets_[findSet(j2)] = findSet(j1);
+}
+
+void SquareMazeStream::generateRow(bool last_row) {
+    // Join adjacent cells of different sets randomly. In the last row all of them have to be joined.
+    for (int j = 0; j < cols_ - 1; j++) {
+        right_open_[j] = 0;
+        if (findSet(j) != findSet(j + 1) && (last_row || (random_engine_() & 1))) {
+            unionSets(j, j + 1);
+            right_open_[j] = 1;
+        }
+    }
+    right_open_[cols_ - 1] = 0;
+
+    if (last_row) {
+        fill(down_open_.begin(), down_open_.end(), 0);
+        return;
+    }
+
+    // Open passages down randomly, but at least one for each set, otherwise the set would be cut off
+    for (int j = 0; j < cols_; j++) {
+        const auto root = findSet(j);
+        remaining_[root]++;
+        next_root_[root] = -1;
+    }
+    for (int j = 0; j < cols_; j++) {
+        const auto root = findSet(j);
+        remaining_[root]--;
+        const auto must_open = next_root_[root] < 0 && remaining_[root] == 0;
+        down_open_[j] = must_open || (random_engine_() & 1);
+        if (down_open_[j] && next_root_[root] < 0) {
+            next_root_[root] = j;
+        }
+    }
+}
+
+void SquareMazeStream::nextRow() {
+    // Cells below a passage stay in the set of the cell above, the others start a new set.
+    // remaining_ is all zeros here, it is used to hold the roots of the current row.
+    for (int j = 0; j < cols_; j++) {
+        remaining_[j] = findSet(j);
+    }
+    for (int j = 0; j < cols_; j++) {
+        sets_[j] = down_open_[j] ? next_root_[remaining_[j]] : j;
+    }
+    fill(remaining_.begin(), remaining_.end(), 0);
+}
+
+void SquareMazeStream::Draw(IPainter& painter, const DrawParams& p) {
+    const auto cell_width = p.cell_width;
+    const auto cell_height = p.cell_height;
+    const auto padding_x = p.stroke_width / 2;
+    const auto padding_y = p.stroke_width / 2;
+    const auto width = cell_width*cols_ + 2*padding_x;
+    const auto height = cell_height*rows_ + 2*padding_y;
+    painter.BeginDraw(width, height);
+
+    // Top side walls
+    for (int j = 0; j < cols_; j++) {
+        if (exits_ && j == 0) {
+            continue;
+        }
+        const auto c = nodeCenter(0, j, cell_width, cell_height, padding_x, padding_y);
+        const auto p = PointParams{c, cell_width, cell_height};
+        painter.DrawLine(P3(p), P4(p), EStyle::WallBlocked);
+    }
+
+    for (int i = 0; i < rows_; i++) {
+        const auto last_row = i == rows_ - 1;
+        generateRow(last_row);
+
+        // Left side wall
+        {
+            const auto c = nodeCenter(i, 0, cell_width, cell_height, padding_x, padding_y);
+            const auto p = PointParams{c, cell_width, cell_height};
+            painter.DrawLine(P4(p), P1(p), EStyle::WallBlocked);
+        }
+
+        for (int j = 0; j < cols_; j++) {
+            const auto c = nodeCenter(i, j, cell_width, cell_height, padding_x, padding_y);
+            const auto p = PointParams{c, cell_width, cell_height};
+            const auto p1{P1(p)};
+            const auto p2{P2(p)};
+            const auto p3{P3(p)};
+
+            if (last_row) {
+                if (!(exits_ && j == cols_ - 1)) {
+                    painter.DrawLine(p1, p2, EStyle::WallBlocked);
+                }
+            } else if (!down_open_[j]) {
+                painter.DrawLine(p1, p2, EStyle::Wall);
+            }
+
+            if (j == cols_ - 1) {
+                painter.DrawLine(p2, p3, EStyle::WallBlocked);
+            } else if (!right_open_[j]) {
+                painter.DrawLine(p2, p3, EStyle::Wall);
+            }
+        }
+
+        if (!last_row) {
+            nextRow();
+        }
+    }
+
+    painter.EndDraw();
+}
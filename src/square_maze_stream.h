@@ -0,0 +1,57 @@
+#pragma once
+
+#include "maze_grid.h"
+
+#include <random>
+#include <vector>
+
+struct IPainter;
+struct DrawParams;
+
+// Rectangular maze generated and drawn row by row with Eller's algorithm
+// https://en.wikipedia.org/wiki/Maze_generation_algorithm#Sets-based_algorithms
+//
+// Unlike SquareMaze this class does not store the whole grid, only the sets of the cells in the current
+// row, so memory is bounded by the number of columns and the number of rows is only limited by the output.
+// Each row is handed to the painter as soon as it is finished. Only the walls are drawn (all cells are
+// visited in a finished maze).
+//
+// The mazes are perfect but not uniform: Eller's algorithm has a bias towards horizontal passages.
+class SquareMazeStream
+{
+public:
+    SquareMazeStream(int rows, int cols, unsigned random_seed);
+
+    SquareMazeStream(const SquareMazeStream&) = delete;
+    SquareMazeStream& operator=(const SquareMazeStream&) = delete;
+
+    void AddExits();
+
+    // Generates the maze and draws it. It can be called only once, the rows are not kept.
+    void Draw(IPainter& painter, const DrawParams& p);
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+private:
+    // Joins cells of the current row and selects the passages to the next row
+    void generateRow(bool last_row);
+    // Sets up the cells of the next row based on the passages of the current one
+    void nextRow();
+
+    // Union-find over the columns of the current row
+    int findSet(int j);
+    void unionSets(int j1, int j2);
+
+    int rows_;
+    int cols_;
+    bool exits_;
+    std::mt19937 random_engine_;
+
+    // State of the current row, each vector has `cols_` items
+    std::vector<int> sets_;             // Parent column of each cell, roots point to themselves
+    std::vector<char> right_open_;      // Passage between columns j and j+1
+    std::vector<char> down_open_;       // Passage to the next row
+    std::vector<int> remaining_;        // Temporary: number of cells of a set not processed yet (by root)
+    std::vector<int> next_root_;        // Temporary: column representing a set in the next row (by root)
+};
@@ -1,50 +1,195 @@
 #include "svg_painter.h"
 
 #include <assert.h>
+#include <stdio.h>
+
+#include <charconv>
 
 using namespace std;
 
-SvgPainter::SvgPainter(ostream& os, const PainterParams& params): os_(os) {
+string svgStyle(IPainter::EStyle style, const PainterParams& params) {
     char buf[128];
-    snprintf(buf, sizeof(buf), "stroke:black;stroke-width:%d;stroke-linecap:round", params.stroke_width);
-    wallStyle_ = buf;
-    snprintf(buf, sizeof(buf), "stroke:red;stroke-width:%d;stroke-linecap:round", params.stroke_width);
-    wallBlockedStyle_ = buf;
+    switch (style) {
+        case IPainter::EStyle::OpenCell: return "fill:darkgray";
+        case IPainter::EStyle::VisitedCell: return "fill:white";
+        case IPainter::EStyle::OnPathCell: return "fill:lightgray";
+        case IPainter::EStyle::Wall:
+            snprintf(buf, sizeof(buf), "stroke:black;stroke-width:%d;stroke-linecap:round", params.stroke_width);
+            return buf;
+        case IPainter::EStyle::WallBlocked:
+            snprintf(buf, sizeof(buf), "stroke:red;stroke-width:%d;stroke-linecap:round", params.stroke_width);
+            return buf;
+        case IPainter::EStyle::Solution:
+            snprintf(buf, sizeof(buf), "stroke:blue;stroke-width:%d;stroke-linecap:round", params.stroke_width);
+            return buf;
+    }
+    assert(0);
+    return {};
 }
 
-void SvgPainter::BeginDraw(int width, int height) {
-    os_ << "<!DOCTYPE svg>\n";
-    os_ << "<svg height=\"" << height << "\" width=\"" << width << "\" xmlns=\"http://www.w3.org/2000/svg\" style=\"background-color:white\">\n";
+namespace {
+
+// Class of the elements drawn with each style in the layers mode
+const char* const STYLE_CLASSES[IPainter::STYLE_COUNT] = {"open", "visited", "on-path", "wall", "blocked", "solution"};
+
+bool isLineStyle(IPainter::EStyle style) {
+    return style == IPainter::EStyle::Wall || style == IPainter::EStyle::WallBlocked
+        || style == IPainter::EStyle::Solution;
 }
 
-void SvgPainter::EndDraw() {
-    os_ << "</svg>\n";
+void appendNumber(string& s, int value) {
+    constexpr size_t MAX_NUMBER_SIZE = 11;
+    const auto size = s.size();
+    s.resize(size + MAX_NUMBER_SIZE);
+    const auto [end, ec] = to_chars(s.data() + size, s.data() + s.size(), value);
+    assert(ec == errc());
+    s.resize(static_cast<size_t>(end - s.data()));
 }
 
-string SvgPainter::toSvgStyle(IPainter::EStyle style) const {
-    switch (style) {
-        case IPainter::EStyle::OpenCell: return "fill:darkgray";
-        case IPainter::EStyle::VisitedCell: return "fill:white";
-        case IPainter::EStyle::OnPathCell: return "fill:lightgray";
-        case IPainter::EStyle::Wall: return wallStyle_;
-        case IPainter::EStyle::WallBlocked: return wallBlockedStyle_;
-        default:
-            assert(0);
+} // namespace
+
+SvgPainter::SvgPainter(ostream& os, const PainterParams& params, ESvgMode mode)
+    : os_(os)
+    , mode_(mode) {
+    for (int style = 0; style < STYLE_COUNT; style++) {
+        styles_[style] = svgStyle(static_cast<EStyle>(style), params);
+        style_attributes_[style] = "\" style=\"" + styles_[style] + "\" />\n";
+    }
+    buffer_.reserve(BUFFER_SIZE + 1024);
+}
+
+SvgPainter::~SvgPainter() {
+    flush();
+}
+
+void SvgPainter::BeginDraw(int width, int height) {
+    append("<!DOCTYPE svg>\n");
+    append("<svg height=\"");
+    append(height);
+    append("\" width=\"");
+    append(width);
+    append("\" xmlns=\"http://www.w3.org/2000/svg\" style=\"background-color:white\">\n");
+    if (mode_ == ESvgMode::Layers) {
+        append("<style>\n");
+        for (int style = 0; style < STYLE_COUNT; style++) {
+            append('.');
+            append(STYLE_CLASSES[style]);
+            append('{');
+            append(styles_[style]);
+            if (isLineStyle(static_cast<EStyle>(style))) {
+                append(";fill:none;stroke-linejoin:round");
+            }
+            append("}\n");
+        }
+        append("</style>\n");
+    }
+}
+
+void SvgPainter::EndDraw() {
+    if (mode_ == ESvgMode::Layers) {
+        // The layers are in the order of the styles: the cells, then the walls and the solution over them
+        for (int style = 0; style < STYLE_COUNT; style++) {
+            if (layers_[style].empty()) {
+                continue;
+            }
+            append("<path class=\"");
+            append(STYLE_CLASSES[style]);
+            append("\" d=\"");
+            flush();
+            os_.write(layers_[style].data(), static_cast<streamsize>(layers_[style].size()));
+            append("\" />\n");
+            layers_[style].clear();
+        }
     }
+    append("</svg>\n");
+    flush();
 }
 
 void SvgPainter::DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) {
-    os_ << "<line x1=\"" << p1.x
-        << "\" y1=\"" << p1.y
-        << "\" x2=\"" << p2.x
-        << "\" y2=\"" << p2.y
-        << "\" style=\"" << toSvgStyle(style) << "\" />\n";
+    if (mode_ == ESvgMode::Layers) {
+        const Point2D vertices[] = {p1, p2};
+        appendToLayer(vertices, 2, false, style);
+        return;
+    }
+    append("<line x1=\"");
+    append(p1.x);
+    append("\" y1=\"");
+    append(p1.y);
+    append("\" x2=\"");
+    append(p2.x);
+    append("\" y2=\"");
+    append(p2.y);
+    endElement(style);
 }
 
 void SvgPainter::DrawPoly(const vector<Point2D>& vertices, EStyle style) {
-    os_ << "<polygon points=\"";
+    if (mode_ == ESvgMode::Layers) {
+        appendToLayer(vertices.data(), vertices.size(), true, style);
+        return;
+    }
+    append("<polygon points=\"");
     for (const auto v : vertices) {
-        os_ << v.x << ',' << v.y << ' ';
+        append(v.x);
+        append(',');
+        append(v.y);
+        append(' ');
+    }
+    endElement(style);
+}
+
+void SvgPainter::DrawPolyline(const vector<Point2D>& vertices, EStyle style) {
+    if (mode_ == ESvgMode::Layers) {
+        appendToLayer(vertices.data(), vertices.size(), false, style);
+        return;
+    }
+    if (vertices.size() <= 2) {
+        IPainter::DrawPolyline(vertices, style);
+        return;
+    }
+    append("<path fill=\"none\" stroke-linejoin=\"round\" d=\"M");
+    for (size_t k = 0; k < vertices.size(); k++) {
+        if (k > 0) {
+            append(' ');
+        }
+        append(vertices[k].x);
+        append(',');
+        append(vertices[k].y);
+    }
+    endElement(style);
+}
+
+void SvgPainter::append(int value) {
+    appendNumber(buffer_, value);
+}
+
+void SvgPainter::endElement(EStyle style) {
+    append(style_attributes_[static_cast<int>(style)]);
+    if (buffer_.size() >= BUFFER_SIZE) {
+        flush();
     }
-    os_ << "\" style=\"" << toSvgStyle(style) << "\" />\n";
+}
+
+void SvgPainter::appendToLayer(const Point2D* vertices, size_t count, bool closed, EStyle style) {
+    if (count == 0) {
+        return;
+    }
+    auto& layer = layers_[static_cast<int>(style)];
+    layer.push_back('M');
+    appendNumber(layer, vertices[0].x);
+    layer.push_back(',');
+    appendNumber(layer, vertices[0].y);
+    for (size_t k = 1; k < count; k++) {
+        layer.append(k == 1 ? "l" : " ");
+        appendNumber(layer, vertices[k].x - vertices[k - 1].x);
+        layer.push_back(',');
+        appendNumber(layer, vertices[k].y - vertices[k - 1].y);
+    }
+    if (closed) {
+        layer.push_back('z');
+    }
+}
+
+void SvgPainter::flush() {
+    os_.write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+    buffer_.clear();
 }
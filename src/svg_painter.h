@@ -2,18 +2,38 @@
 
 #include "painter.h"
 
+#include <stddef.h>
+
 #include <ostream>
 #include <string>
+#include <string_view>
 
 struct PainterParams
 {
     int stroke_width;
 };
 
+// SVG style attribute of the elements drawn with `style`
+std::string svgStyle(IPainter::EStyle style, const PainterParams& params);
+
+// How SvgPainter writes the elements
+enum class ESvgMode
+{
+    Inline, // An element per cell, line or polyline, each with its style attribute
+    Layers, // A <path> per style with all the elements drawn with it, the styles are classes of a <style> block
+};
+
+// Painter writing a single SVG image
+//
+// The elements are formatted with std::to_chars into a buffer which is written to the stream in chunks of
+// about BUFFER_SIZE bytes, and at EndDraw. In the layers mode the data of the paths is kept until EndDraw,
+// in relative coordinates (cells of the same shape have the same data but their start point), and the
+// number of elements does not depend on the size of the maze.
 class SvgPainter : public IPainter
 {
 public:
-    explicit SvgPainter(std::ostream& os, const PainterParams& params);
+    explicit SvgPainter(std::ostream& os, const PainterParams& params, ESvgMode mode = ESvgMode::Inline);
+    ~SvgPainter() override;
 
     SvgPainter(const SvgPainter&) = delete;
     SvgPainter& operator=(const SvgPainter&) = delete;
@@ -22,11 +42,29 @@ public:
     void EndDraw() override;
     void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) override;
     void DrawPoly(const std::vector<Point2D>& vertices, EStyle style) override;
+    // A <path> element, or a <line> for a single segment
+    void DrawPolyline(const std::vector<Point2D>& vertices, EStyle style) override;
+
+    // Size of the chunks written to the stream
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
 
 private:
-    std::string toSvgStyle(IPainter::EStyle style) const;
+    void append(std::string_view s) { buffer_.append(s); }
+    void append(char c) { buffer_.push_back(c); }
+    void append(int value);
+    // Ends an element with its style, and writes the buffer once it is full
+    void endElement(EStyle style);
+    // Appends the vertices to the path data of the layer of `style`, closed for a polygon
+    void appendToLayer(const Point2D* vertices, size_t count, bool closed, EStyle style);
+    void flush();
 
     std::ostream& os_;
-    std::string wallStyle_;
-    std::string wallBlockedStyle_;
+    const ESvgMode mode_;
+    // svgStyle() of each style
+    std::string styles_[STYLE_COUNT];
+    // End of the elements drawn with each style: the style attribute and the closing of the tag
+    std::string style_attributes_[STYLE_COUNT];
+    std::string buffer_;
+    // Path data of each style in the layers mode
+    std::string layers_[STYLE_COUNT];
 };
@@ -0,0 +1,127 @@
+#include "src/animated_svg_painter.h"
+#include "src/brick_maze.h"
+#include "src/hexmaze.h"
+#include "src/maze_journal.h"
+#include "src/square_maze.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+static int countOf(const std::string& s, const std::string& what) {
+    auto count = 0;
+    for (auto pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+using EStyle = IPainter::EStyle;
+
+// Each element is written once, with the changes of its style and visibility between the frames
+TEST(AnimatedSvgPainterTest, Changes) {
+    AnimatedSvgPainter painter({2});
+    const std::vector<Point2D> cell = {{0, 0}, {10, 0}, {10, 10}};
+
+    painter.BeginDraw(20, 20);
+    painter.DrawPoly(cell, EStyle::OpenCell);
+    painter.DrawLine({0, 0}, {10, 0}, EStyle::Wall);
+    painter.EndDraw();
+    painter.BeginDraw(20, 20);
+    painter.DrawPoly(cell, EStyle::OnPathCell);
+    painter.EndDraw();
+    painter.BeginDraw(20, 20);
+    painter.DrawPoly(cell, EStyle::VisitedCell);
+    painter.DrawLine({0, 0}, {10, 0}, EStyle::Wall);
+    painter.DrawLine({10, 0}, {10, 10}, EStyle::Wall);
+    painter.EndDraw();
+    EXPECT_EQ(painter.frameCount(), 3);
+
+    std::ostringstream os;
+    painter.Write(os, 0.5);
+    const auto svg = os.str();
+    EXPECT_EQ(countOf(svg, "<polygon"), 1);
+    EXPECT_EQ(countOf(svg, "<line"), 2);
+    // Cell: two style changes. First wall: hidden and visible again. Second wall: hidden until the last frame.
+    EXPECT_EQ(countOf(svg, "<set attributeName=\"fill\""), 2);
+    EXPECT_EQ(countOf(svg, "to=\"hidden\""), 1);
+    EXPECT_EQ(countOf(svg, "to=\"visible\""), 2);
+    EXPECT_EQ(countOf(svg, "visibility=\"hidden\""), 1);
+    EXPECT_NE(svg.find("begin=\"0.5s\""), std::string::npos);
+    EXPECT_NE(svg.find("begin=\"1s\""), std::string::npos);
+}
+
+// The styles are presentation attributes, the animatable ones are set. The style attribute is not
+// animatable, it is not used at all.
+TEST(AnimatedSvgPainterTest, AnimatedAttributes) {
+    AnimatedSvgPainter painter({2});
+    painter.BeginDraw(20, 20);
+    painter.DrawPoly({{0, 0}, {10, 0}, {10, 10}}, EStyle::OpenCell);
+    painter.DrawLine({0, 0}, {10, 0}, EStyle::Wall);
+    painter.EndDraw();
+    painter.BeginDraw(20, 20);
+    painter.DrawPoly({{0, 0}, {10, 0}, {10, 10}}, EStyle::OnPathCell);
+    painter.DrawLine({0, 0}, {10, 0}, EStyle::WallBlocked);
+    painter.EndDraw();
+
+    std::ostringstream os;
+    painter.Write(os, 1.0);
+    const auto svg = os.str();
+    EXPECT_EQ(countOf(svg, "style="), 1); // The background of the <svg> only
+    EXPECT_NE(svg.find("<polygon points=\"0,0 10,0 10,10 \" fill=\"darkgray\">"), std::string::npos);
+    EXPECT_NE(svg.find("<line x1=\"0\" y1=\"0\" x2=\"10\" y2=\"0\" stroke=\"black\" stroke-width=\"2\" "
+                       "stroke-linecap=\"round\">"), std::string::npos);
+    EXPECT_NE(svg.find("<set attributeName=\"fill\" to=\"lightgray\" begin=\"1s\" fill=\"freeze\" />"),
+              std::string::npos);
+    // Only the attributes that change are set
+    EXPECT_NE(svg.find("<set attributeName=\"stroke\" to=\"red\" begin=\"1s\" fill=\"freeze\" />"),
+              std::string::npos);
+    EXPECT_EQ(countOf(svg, "<set"), 2);
+}
+
+// Frames without changes add nothing
+TEST(AnimatedSvgPainterTest, StillFrames) {
+    AnimatedSvgPainter painter({2});
+    for (int frame = 0; frame < 10; frame++) {
+        painter.BeginDraw(20, 20);
+        painter.DrawLine({0, 0}, {10, 0}, EStyle::Wall);
+        painter.EndDraw();
+    }
+    std::ostringstream os;
+    painter.Write(os, 0.1);
+    EXPECT_EQ(countOf(os.str(), "<set"), 0);
+    EXPECT_EQ(countOf(os.str(), "<line"), 1);
+}
+
+// The animation of a recorded generation has every cell once and ends with the generated maze
+template< typename Maze >
+static void checkAnimation() {
+    Maze m(8, 10);
+    m.AddExits();
+    MazeJournal journal;
+    ASSERT_EQ(m.RecordMaze({}, nullptr, journal), ECreateMazeResult::Ok);
+
+    Maze replay(8, 10);
+    replay.AddExits();
+    AnimatedSvgPainter painter({2});
+    replay.DrawAnimation(painter, {20, 20, 2}, journal, 50);
+    EXPECT_EQ(painter.frameCount(), 51);
+
+    std::ostringstream os;
+    painter.Write(os, 0.1);
+    EXPECT_EQ(countOf(os.str(), "<polygon"), m.nodeCount());
+    EXPECT_GT(countOf(os.str(), "<set"), m.nodeCount());
+    for (int id = 0; id < m.nodeCount(); id++) {
+        const auto node = m.nodeFromId(id);
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            EXPECT_EQ(replay.getEdge(node, edge), m.getEdge(node, edge));
+        }
+    }
+}
+
+TEST(AnimatedSvgPainterTest, RecordedGeneration) {
+    checkAnimation<HexMaze>();
+    checkAnimation<SquareMaze>();
+    checkAnimation<BrickMaze>();
+}
@@ -1,4 +1,5 @@
 #include "src/brick_maze.h"
+#include "src/painter.h"
 
 #include <gtest/gtest.h>
 
@@ -100,3 +101,35 @@ INSTANTIATE_TEST_SUITE_P(InvalidCases, BrickMazeNextNodeTest, ::testing::Values(
     NextNodeTestParam{{0, 0}, 7, BrickMaze::invalidNode()}));
 
 // TODO: add the rest like with the other types
+
+//----------------------------------------------------------------------------------------------------
+
+// Counts the walls drawn with each style
+class WallCounter : public IPainter
+{
+public:
+    void BeginDraw(int, int) override {}
+    void EndDraw() override {}
+    void DrawLine(const Point2D&, const Point2D&, EStyle style) override {
+        counts[static_cast<int>(style)]++;
+    }
+    void DrawPoly(const std::vector<Point2D>&, EStyle) override {}
+
+    int counts[IPainter::STYLE_COUNT] = {};
+};
+
+// An exit through one of the two top walls of a cell leaves the other one with its own style
+TEST(BrickMazeDrawTest, TopExit) {
+    BrickMaze m(2, 3);
+    const DrawParams p = {20, 20, 2, true};
+    WallCounter closed;
+    m.Draw(closed, p);
+
+    m.setEdge({0, 1}, 4, EEdge::Visited);
+    WallCounter exit;
+    m.Draw(exit, p);
+    EXPECT_EQ(exit.counts[static_cast<int>(IPainter::EStyle::WallBlocked)],
+              closed.counts[static_cast<int>(IPainter::EStyle::WallBlocked)] - 1);
+    EXPECT_EQ(exit.counts[static_cast<int>(IPainter::EStyle::Wall)],
+              closed.counts[static_cast<int>(IPainter::EStyle::Wall)]);
+}
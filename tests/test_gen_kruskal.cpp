@@ -0,0 +1,70 @@
+#include "src/gen_kruskal.h"
+#include "src/brick_maze.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+// All nodes are added to the maze and they form a tree, for all grid types
+TEST(GenKruskalTest, CreatesSpanningTree) {
+    for (unsigned seed = 0; seed < 5; seed++) {
+        HexMaze hex(15, 20);
+        EXPECT_EQ(CreateMazeKruskal<HexMaze>(seed).createMaze(hex), ECreateMazeResult::Ok);
+        EXPECT_EQ(hex.getOpenNode(), HexMaze::invalidNode());
+        EXPECT_TRUE(isSpanningTree(hex, 6));
+
+        SquareMaze square(15, 20);
+        EXPECT_EQ(CreateMazeKruskal<SquareMaze>(seed).createMaze(square), ECreateMazeResult::Ok);
+        EXPECT_EQ(square.getOpenNode(), SquareMaze::invalidNode());
+        EXPECT_TRUE(isSpanningTree(square, 4));
+
+        BrickMaze brick(15, 20);
+        EXPECT_EQ(CreateMazeKruskal<BrickMaze>(seed).createMaze(brick), ECreateMazeResult::Ok);
+        EXPECT_EQ(brick.getOpenNode(), BrickMaze::invalidNode());
+        EXPECT_TRUE(isSpanningTree(brick, 6));
+    }
+}
+
+// Each tree edge and each node added is reported to the observer
+TEST(GenKruskalTest, Observer) {
+    SquareMaze m(15, 20);
+    m.setNode({0, 0}, ENode::Visited);
+    CreateMazeKruskal<SquareMaze, CountingObserver> maze_gen(1);
+    ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+
+    EXPECT_EQ(maze_gen.observer().edge_changes, m.nodeCount() - 1);
+    EXPECT_EQ(maze_gen.observer().node_changes, m.nodeCount() - 1);
+    EXPECT_EQ(maze_gen.observer().walks, 0);
+}
+
+// Invalid regions are left out and exits are kept
+TEST(GenKruskalTest, InvalidRegionAndExits) {
+    SquareMaze m(10, 10);
+    m.invalidateRegion({3, 3}, {6, 4});
+    m.AddExits();
+
+    EXPECT_EQ(CreateMazeKruskal<SquareMaze>(1).createMaze(m), ECreateMazeResult::Ok);
+    EXPECT_EQ(m.getNode({3, 3}), ENode::Invalid);
+    EXPECT_EQ(m.getEdge({0, 0}, 3), EEdge::Visited);
+    EXPECT_TRUE(isSpanningTree(m, 4));
+}
+
+// Nodes already visited are connected to the new tree as a single tree
+TEST(GenKruskalTest, ExtendsExistingTree) {
+    SquareMaze m(2, 2);
+    m.setNode({0, 0}, ENode::Visited);
+    m.setNode({0, 1}, ENode::Visited);
+    m.setEdge({0, 0}, 2, EEdge::Visited);
+
+    EXPECT_EQ(CreateMazeKruskal<SquareMaze>(3).createMaze(m), ECreateMazeResult::Ok);
+    EXPECT_TRUE(isSpanningTree(m, 4));
+}
+
+// No open node is an error
+TEST(GenKruskalTest, NoFirstOpenNode) {
+    SquareMaze m(1, 1);
+    m.setNode({0, 0}, ENode::Visited);
+
+    EXPECT_EQ(CreateMazeKruskal<SquareMaze>(0).createMaze(m), ECreateMazeResult::ErrNoFirstOpenNode);
+}
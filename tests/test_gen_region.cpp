@@ -0,0 +1,121 @@
+#include "src/gen_region.h"
+#include "src/brick_maze.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+
+// State of all edges of all nodes, exits included
+template< typename Maze >
+static std::vector<EEdge> edgeStates(const Maze& m) {
+    std::vector<EEdge> states;
+    for (int id = 0; id < m.nodeCount(); id++) {
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            states.push_back(m.getEdge(m.nodeFromId(id), edge));
+        }
+    }
+    return states;
+}
+
+// The maze is still a spanning tree, only the edges between two cells of the region change
+template< typename Maze >
+static void checkRegeneration(NodeIndex2D top_left, NodeIndex2D bottom_right) {
+    const auto inRegion = [&](NodeIndex2D node) {
+        return top_left.i <= node.i && node.i <= bottom_right.i && top_left.j <= node.j && node.j <= bottom_right.j;
+    };
+    auto changed = 0;
+    for (unsigned seed = 0; seed < 5; seed++) {
+        Maze m(20, 30);
+        m.AddExits();
+        CreateMazeParams params;
+        params.random_seed = seed;
+        ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+        const auto before = edgeStates(m);
+
+        RegenerateRegionWilson<Maze> regen(seed);
+        regen.regenerate(m, top_left, bottom_right);
+        EXPECT_TRUE(isSpanningTree(m, Maze::EDGE_COUNT));
+        EXPECT_GT(regen.stats().wilson_walks, 0);
+
+        const auto after = edgeStates(m);
+        for (size_t k = 0; k < after.size(); k++) {
+            const auto node = m.nodeFromId(static_cast<int>(k / Maze::EDGE_COUNT));
+            const auto edge = static_cast<int>(k % Maze::EDGE_COUNT) + 1;
+            if (!inRegion(node) || !inRegion(Maze::nextNode(node, edge))) {
+                EXPECT_EQ(before[k], after[k]) << k;
+            } else if (before[k] != after[k]) {
+                changed++;
+            }
+        }
+    }
+    EXPECT_GT(changed, 0);
+}
+
+TEST(GenRegionTest, KeepsRestOfMaze) {
+    checkRegeneration<HexMaze>({5, 6}, {12, 17});
+    checkRegeneration<SquareMaze>({5, 6}, {12, 17});
+    checkRegeneration<BrickMaze>({5, 6}, {12, 17});
+    // Regions at the border, with the exits
+    checkRegeneration<SquareMaze>({0, 0}, {4, 29});
+    checkRegeneration<HexMaze>({15, 20}, {19, 29});
+}
+
+// Invalid nodes stay out of the maze, the region is clipped to the grid
+TEST(GenRegionTest, InvalidNodesAndClipping) {
+    HexMaze m(15, 15);
+    m.invalidateRegion({4, 4}, {6, 6});
+    ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+
+    RegenerateRegionWilson<HexMaze> regen(1);
+    regen.regenerate(m, {2, 2}, {9, 9});
+    EXPECT_TRUE(isSpanningTree(m, 6));
+    EXPECT_EQ(m.getNode({5, 5}), ENode::Invalid);
+
+    regen.regenerate(m, {-3, 10}, {20, 40});
+    EXPECT_TRUE(isSpanningTree(m, 6));
+}
+
+// The columns of the comb are connected through the top row only, so each column is a piece of its own
+// in the region below the top row. Joining two of them would close a loop: the maze cannot change.
+//   +---+---+
+//   |   |   |
+//   +   +   +
+//   |   |   |
+//   +   +   +
+TEST(GenRegionTest, SeparatePieces) {
+    SquareMaze m(3, 3);
+    buildMaze(m, {{{0, 0}, 2}, {{0, 1}, 2},
+                  {{0, 0}, 1}, {{1, 0}, 1},
+                  {{0, 1}, 1}, {{1, 1}, 1},
+                  {{0, 2}, 1}, {{1, 2}, 1}});
+    const auto before = edgeStates(m);
+
+    for (unsigned seed = 0; seed < 10; seed++) {
+        RegenerateRegionWilson<SquareMaze> regen(seed);
+        regen.regenerate(m, {1, 0}, {2, 2});
+        EXPECT_EQ(edgeStates(m), before);
+    }
+}
+
+// The 15 spanning trees of a 2x3 grid regenerated as a whole must have the same probability (see
+// GenWilsonArrowsTest.Uniform)
+TEST(GenRegionTest, Uniform) {
+    const auto samples = 6000;
+    const auto trees = 15;
+
+    std::map<int, int> counts;
+    for (int seed = 0; seed < samples; seed++) {
+        SquareMaze m(2, 3);
+        ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+        RegenerateRegionWilson<SquareMaze> regen(seed);
+        regen.regenerate(m, {0, 0}, {1, 2});
+        counts[treeKey(m)]++;
+    }
+
+    EXPECT_EQ(counts.size(), trees);
+    EXPECT_LT(chiSquared(counts, trees, samples), 45.0);
+}
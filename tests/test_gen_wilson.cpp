@@ -1,4 +1,7 @@
 #include "src/gen_wilson.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -7,10 +10,9 @@ using ::testing::_;
 using ::testing::AtMost;
 using ::testing::InSequence;
 using ::testing::Return;
-using ::testing::SetArgReferee;
 
 // CreateMazeWilson is tested with MockMaze. Which edge will be selected during traversal is determined
-// by the return value of getOpenEdges that can change over the course of a test. Thus random selection
+// by the return value of getOpenEdgeMask that can change over the course of a test. Thus random selection
 // of the edges is ignored in these tests. (A separate test later verifies that edges are selected randomly.)
 class MockMaze {
 public:
@@ -20,7 +22,7 @@ public:
     MOCK_METHOD(ENode, getNode, (NodeIndex node), (const));
     MOCK_METHOD(void, setNode, (NodeIndex node, ENode val));
 
-    MOCK_METHOD(void, getOpenEdges, (NodeIndex node, std::vector<EdgeIndex>& edges), (const));
+    MOCK_METHOD(EdgeMask, getOpenEdgeMask, (NodeIndex node), (const));
     MOCK_METHOD(void, setEdge, (NodeIndex node, EdgeIndex edge, EEdge val));
 
     MOCK_METHOD(NodeIndex, getOpenNode, (), (const));
@@ -30,6 +32,14 @@ public:
 
 using MazeGen = CreateMazeWilson<MockMaze>;
 
+static EdgeMask edgeMask(std::initializer_list<int> edges) {
+    EdgeMask mask = 0;
+    for (const auto edge : edges) {
+        mask |= 1 << edge;
+    }
+    return mask;
+}
+
 // No open node at the first step is an error
 TEST(GenWilsonTest, NoFirstOpenNode) {
     MockMaze m;
@@ -59,7 +69,7 @@ TEST(GenWilsonTest, OneStepFromStart) {
     MockMaze m;
 
     const auto n0 = 0, n1 = 1;
-    const auto e10 = 10;
+    const auto e10 = 1;
 
     InSequence s;
     // First node is added automatically
@@ -69,7 +79,7 @@ TEST(GenWilsonTest, OneStepFromStart) {
     // Second open node will start a path
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e10})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e10})));
     EXPECT_CALL(m, nextNode(n1, e10)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n1, e10, EEdge::OnPath));
     // Found a visited node, the path is finished
@@ -93,7 +103,7 @@ TEST(GenWilsonTest, TwoStepsFromStart) {
     MockMaze m;
 
     const auto n0 = 0, n1 = 1, n2 = 2;
-    const auto e12 = 12, e20 = 20;
+    const auto e12 = 3, e20 = 4;
 
     InSequence s;
     // First node is added automatically
@@ -103,13 +113,13 @@ TEST(GenWilsonTest, TwoStepsFromStart) {
     // Second open node will start a path
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e12})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e12})));
     EXPECT_CALL(m, nextNode(n1, e12)).WillOnce(Return(n2));
     EXPECT_CALL(m, setEdge(n1, e12, EEdge::OnPath));
 
     EXPECT_CALL(m, getNode(n2)).WillOnce(Return(ENode::Open));
     EXPECT_CALL(m, setNode(n2, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n2, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e20})));
+    EXPECT_CALL(m, getOpenEdgeMask(n2)).WillOnce(Return(edgeMask({e20})));
     EXPECT_CALL(m, nextNode(n2, e20)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n2, e20, EEdge::OnPath));
 
@@ -136,7 +146,7 @@ TEST(GenWilsonTest, LoopOnStart) {
     MockMaze m;
 
     const auto n0 = 0, n1 = 1, n2 = 2;
-    const auto e12 = 12, e21 = 21, e10 = 10;
+    const auto e12 = 3, e21 = 5, e10 = 1;
 
     InSequence s;
     // First node is added automatically
@@ -146,13 +156,13 @@ TEST(GenWilsonTest, LoopOnStart) {
     // Second open node will start a path
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e12})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e12})));
     EXPECT_CALL(m, nextNode(n1, e12)).WillOnce(Return(n2));
     EXPECT_CALL(m, setEdge(n1, e12, EEdge::OnPath));
 
     EXPECT_CALL(m, getNode(n2)).WillOnce(Return(ENode::Open));
     EXPECT_CALL(m, setNode(n2, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n2, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e21})));
+    EXPECT_CALL(m, getOpenEdgeMask(n2)).WillOnce(Return(edgeMask({e21})));
     // e21 leads back to n1
     EXPECT_CALL(m, nextNode(n2, e21)).WillOnce(Return(n1));
     EXPECT_CALL(m, setEdge(n2, e21, EEdge::OnPath));
@@ -164,7 +174,7 @@ TEST(GenWilsonTest, LoopOnStart) {
     EXPECT_CALL(m, setNode(n2, ENode::Open));
     EXPECT_CALL(m, setEdge(n1, e12, EEdge::Open));
     // now go to n0
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e10})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e10})));
     EXPECT_CALL(m, nextNode(n1, e10)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n1, e10, EEdge::OnPath));
 
@@ -189,7 +199,7 @@ TEST(GenWilsonTest, LoopOnOtherNode) {
     MockMaze m;
 
     const auto n0 = 0, n1 = 1, n2 = 2, n3 = 3, n4 = 4;
-    const auto e12 = 12, e23 = 23, e34 = 34, e42 = 42, e20 = 20;
+    const auto e12 = 3, e23 = 7, e34 = 8, e42 = 9, e20 = 4;
 
     InSequence s;
     // First node is added automatically
@@ -200,25 +210,25 @@ TEST(GenWilsonTest, LoopOnOtherNode) {
     // n1 -> n2
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e12})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e12})));
     EXPECT_CALL(m, nextNode(n1, e12)).WillOnce(Return(n2));
     EXPECT_CALL(m, setEdge(n1, e12, EEdge::OnPath));
     // n2 -> n3
     EXPECT_CALL(m, getNode(n2)).WillOnce(Return(ENode::Open));
     EXPECT_CALL(m, setNode(n2, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n2, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e23})));
+    EXPECT_CALL(m, getOpenEdgeMask(n2)).WillOnce(Return(edgeMask({e23})));
     EXPECT_CALL(m, nextNode(n2, e23)).WillOnce(Return(n3));
     EXPECT_CALL(m, setEdge(n2, e23, EEdge::OnPath));
     // n3 -> n4
     EXPECT_CALL(m, getNode(n3)).WillOnce(Return(ENode::Open));
     EXPECT_CALL(m, setNode(n3, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n3, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e34})));
+    EXPECT_CALL(m, getOpenEdgeMask(n3)).WillOnce(Return(edgeMask({e34})));
     EXPECT_CALL(m, nextNode(n3, e34)).WillOnce(Return(n4));
     EXPECT_CALL(m, setEdge(n3, e34, EEdge::OnPath));
     // n4 -> n2
     EXPECT_CALL(m, getNode(n4)).WillOnce(Return(ENode::Open));
     EXPECT_CALL(m, setNode(n4, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n4, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e42})));
+    EXPECT_CALL(m, getOpenEdgeMask(n4)).WillOnce(Return(edgeMask({e42})));
     EXPECT_CALL(m, nextNode(n4, e42)).WillOnce(Return(n2));
     EXPECT_CALL(m, setEdge(n4, e42, EEdge::OnPath));
 
@@ -232,7 +242,7 @@ TEST(GenWilsonTest, LoopOnOtherNode) {
     EXPECT_CALL(m, setEdge(n2, e23, EEdge::Open));
 
     // Now go to n0
-    EXPECT_CALL(m, getOpenEdges(n2, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e20})));
+    EXPECT_CALL(m, getOpenEdgeMask(n2)).WillOnce(Return(edgeMask({e20})));
     EXPECT_CALL(m, nextNode(n2, e20)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n2, e20, EEdge::OnPath));
 
@@ -259,7 +269,7 @@ TEST(GenWilsonTest, SelfLoopOnStartNode) {
     MockMaze m;
 
     const auto n0 = 0, n1 = 1;
-    const auto e11 = 11, e10 = 10;
+    const auto e11 = 2, e10 = 1;
 
     InSequence s;
     // First node is added automatically
@@ -269,7 +279,7 @@ TEST(GenWilsonTest, SelfLoopOnStartNode) {
     // Second open node will start a path
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e11})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e11})));
     EXPECT_CALL(m, nextNode(n1, e11)).WillOnce(Return(n1));
     EXPECT_CALL(m, setEdge(n1, e11, EEdge::OnPath));
 
@@ -277,7 +287,7 @@ TEST(GenWilsonTest, SelfLoopOnStartNode) {
     // Erase the loop
     EXPECT_CALL(m, setEdge(n1, e11, EEdge::Open));
     // Now go to n0
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e10})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e10})));
     EXPECT_CALL(m, nextNode(n1, e10)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n1, e10, EEdge::OnPath));
 
@@ -302,7 +312,7 @@ TEST(GenWilsonTest, SelfLoopOnOtherNode) {
     MockMaze m;
 
     const auto n0 = 0, n1 = 1, n2 = 2;
-    const auto e12 = 12, e22 = 22, e20 = 20;
+    const auto e12 = 3, e22 = 6, e20 = 4;
 
     InSequence s;
     // First node is added automatically
@@ -312,13 +322,13 @@ TEST(GenWilsonTest, SelfLoopOnOtherNode) {
     // Second open node will start a path
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e12})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({e12})));
     EXPECT_CALL(m, nextNode(n1, e12)).WillOnce(Return(n2));
     EXPECT_CALL(m, setEdge(n1, e12, EEdge::OnPath));
 
     EXPECT_CALL(m, getNode(n2)).WillOnce(Return(ENode::Open));
     EXPECT_CALL(m, setNode(n2, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n2, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e22})));
+    EXPECT_CALL(m, getOpenEdgeMask(n2)).WillOnce(Return(edgeMask({e22})));
     EXPECT_CALL(m, nextNode(n2, e22)).WillOnce(Return(n2));
     EXPECT_CALL(m, setEdge(n2, e22, EEdge::OnPath));
 
@@ -326,7 +336,7 @@ TEST(GenWilsonTest, SelfLoopOnOtherNode) {
     // Erase the loop
     EXPECT_CALL(m, setEdge(n2, e22, EEdge::Open));
     // Find another edge
-    EXPECT_CALL(m, getOpenEdges(n2, _)).WillOnce(SetArgReferee<1>(std::vector<int>({e20})));
+    EXPECT_CALL(m, getOpenEdgeMask(n2)).WillOnce(Return(edgeMask({e20})));
     EXPECT_CALL(m, nextNode(n2, e20)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n2, e20, EEdge::OnPath));
 
@@ -371,7 +381,7 @@ TEST_P(GenWilsonRandomTest, RandomEdgeSelection) {
     // Second open node will start a path
     EXPECT_CALL(m, getOpenNode()).WillOnce(Return(n1));
     EXPECT_CALL(m, setNode(n1, ENode::OnPath));
-    EXPECT_CALL(m, getOpenEdges(n1, _)).WillOnce(SetArgReferee<1>(std::vector<int>({1, 2, 3, 4, 5, 6})));
+    EXPECT_CALL(m, getOpenEdgeMask(n1)).WillOnce(Return(edgeMask({1, 2, 3, 4, 5, 6})));
 
     EXPECT_CALL(m, nextNode(n1, edge)).WillOnce(Return(n0));
     EXPECT_CALL(m, setEdge(n1, edge, EEdge::OnPath));
@@ -392,9 +402,70 @@ TEST_P(GenWilsonRandomTest, RandomEdgeSelection) {
     EXPECT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
 }
 
-// Edges are selected randomly (based on the seed of the generator)
+// Edges are selected randomly (based on the seed of the generator). The selection does not depend on the
+// platform, so these are the same everywhere.
 INSTANTIATE_TEST_SUITE_P(, GenWilsonRandomTest, ::testing::Values(
-    GenWilsonRandomTestParam{0, 5},
-    GenWilsonRandomTestParam{1, 6},
-    GenWilsonRandomTestParam{2, 1},
-    GenWilsonRandomTestParam{3, 3}));
+    GenWilsonRandomTestParam{0, 6},
+    GenWilsonRandomTestParam{1, 2},
+    GenWilsonRandomTestParam{2, 5},
+    GenWilsonRandomTestParam{4, 1}));
+
+//----------------------------------------------------------------------------------------------------
+// Observer policy
+
+// Every step of a walk is either erased with a loop or adds a node to the maze
+TEST(GenWilsonObserverTest, CountsEvents) {
+    HexMaze m(20, 30);
+    CreateMazeWilson<HexMaze, Pcg32, CountingObserver> maze_gen(1);
+    ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+
+    const auto& observer = maze_gen.observer();
+    EXPECT_EQ(observer.walks, maze_gen.stats().wilson_walks);
+    EXPECT_GT(observer.loops, 0);
+    EXPECT_EQ(observer.erased_steps + m.nodeCount() - 1, maze_gen.stats().wilson_steps);
+    EXPECT_GE(observer.node_changes, 2 * m.nodeCount() - 1);
+    EXPECT_GE(observer.edge_changes, 2 * (m.nodeCount() - 1));
+}
+
+// Applies the node and edge changes to another grid
+class ReplayObserver
+{
+public:
+    explicit ReplayObserver(SquareMaze& maze): maze_(maze) {}
+
+    void onEvent(const NodeChangedEvent<NodeIndex2D>& event) { maze_.setNode(event.node, event.state); }
+    void onEvent(const EdgeChangedEvent<NodeIndex2D>& event) { maze_.setEdge(event.node, event.edge, event.state); }
+    template< typename Event >
+    void onEvent(const Event&) {}
+
+private:
+    SquareMaze& maze_;
+};
+
+// The changes reported to the observer are all the changes of the maze
+TEST(GenWilsonObserverTest, ReplayEvents) {
+    SquareMaze m(10, 12);
+    SquareMaze replay(10, 12);
+    CreateMazeWilson<SquareMaze, Pcg32, ReplayObserver> maze_gen(3, ReplayObserver(replay));
+    ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+
+    EXPECT_EQ(treeKey(replay), treeKey(m));
+    EXPECT_TRUE(isSpanningTree(replay, 4));
+    EXPECT_EQ(replay.getOpenNode(), SquareMaze::invalidNode());
+}
+
+//----------------------------------------------------------------------------------------------------
+// Counters, tested on a real grid
+
+// Every node except the first one is added by a walk step, and each walk adds at least one node
+TEST(GenWilsonStatsTest, CountsWalksAndSteps) {
+    HexMaze m(20, 30);
+    CreateMazeWilson<HexMaze> maze_gen(1);
+    ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+    EXPECT_TRUE(isSpanningTree(m, 6));
+
+    const auto& stats = maze_gen.stats();
+    EXPECT_GT(stats.wilson_walks, 0);
+    EXPECT_LE(stats.wilson_walks, m.nodeCount() - 1);
+    EXPECT_GE(stats.wilson_steps, m.nodeCount() - 1);
+}
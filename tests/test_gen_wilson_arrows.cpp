@@ -0,0 +1,87 @@
+#include "src/gen_wilson_arrows.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+// All nodes are added to the maze and they form a tree
+TEST(GenWilsonArrowsTest, CreatesSpanningTree) {
+    HexMaze m(20, 30);
+    CreateMazeWilsonArrows<HexMaze> maze_gen(1);
+    EXPECT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+    EXPECT_EQ(m.getOpenNode(), HexMaze::invalidNode());
+    EXPECT_TRUE(isSpanningTree(m, 6));
+    EXPECT_GT(maze_gen.stats().wilson_walks, 0);
+    EXPECT_GE(maze_gen.stats().wilson_steps, 20*30 - 1);
+}
+
+// No open node at the first step is an error
+TEST(GenWilsonArrowsTest, NoFirstOpenNode) {
+    SquareMaze m(1, 1);
+    m.setNode({0, 0}, ENode::Visited);
+
+    CreateMazeWilsonArrows<SquareMaze> maze_gen(0);
+    EXPECT_EQ(maze_gen.createMaze(m), ECreateMazeResult::ErrNoFirstOpenNode);
+}
+
+// The loop-erased walk is the path of the last exits: with the same seed the maze and the number of steps
+// are the same as those of CreateMazeWilson
+TEST(GenWilsonArrowsTest, SameMazeAsSequential) {
+    for (unsigned seed = 0; seed < 10; seed++) {
+        HexMaze m1(15, 20);
+        m1.invalidateRegion({5, 5}, {8, 10});
+        m1.AddExits();
+        CreateMazeWilson<HexMaze> gen1(seed);
+        ASSERT_EQ(gen1.createMaze(m1), ECreateMazeResult::Ok);
+
+        HexMaze m2(15, 20);
+        m2.invalidateRegion({5, 5}, {8, 10});
+        m2.AddExits();
+        CreateMazeWilsonArrows<HexMaze> gen2(seed);
+        ASSERT_EQ(gen2.createMaze(m2), ECreateMazeResult::Ok);
+
+        for (int id = 0; id < m1.nodeCount(); id++) {
+            const auto node = m1.nodeFromId(id);
+            EXPECT_EQ(m1.getNode(node), m2.getNode(node));
+            for (int edge = 1; edge <= 6; edge++) {
+                EXPECT_EQ(m1.getEdge(node, edge), m2.getEdge(node, edge)) << id << ", " << edge;
+            }
+        }
+        EXPECT_EQ(gen1.stats().wilson_steps, gen2.stats().wilson_steps);
+        EXPECT_EQ(gen1.stats().wilson_walks, gen2.stats().wilson_walks);
+    }
+}
+
+// Only the final path of a walk is written, so each node and each tree edge is reported once
+TEST(GenWilsonArrowsTest, Observer) {
+    HexMaze m(20, 30);
+    CreateMazeWilsonArrows<HexMaze, Pcg32, CountingObserver> maze_gen(1);
+    ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+
+    const auto& observer = maze_gen.observer();
+    EXPECT_EQ(observer.walks, maze_gen.stats().wilson_walks);
+    EXPECT_EQ(observer.loops, 0);
+    EXPECT_EQ(observer.node_changes, m.nodeCount());
+    EXPECT_EQ(observer.edge_changes, m.nodeCount() - 1);
+}
+
+// A 2x3 grid has 15 spanning trees, all of them must have the same probability.
+// With 14 degrees of freedom the statistic exceeds 45 with a probability of less than 0.01%.
+TEST(GenWilsonArrowsTest, Uniform) {
+    const auto samples = 6000;
+    const auto trees = 15;
+
+    std::map<int, int> counts;
+    for (int seed = 0; seed < samples; seed++) {
+        SquareMaze m(2, 3);
+        CreateMazeWilsonArrows<SquareMaze> maze_gen(seed);
+        ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+        counts[treeKey(m)]++;
+    }
+
+    EXPECT_EQ(counts.size(), trees);
+    EXPECT_LT(chiSquared(counts, trees, samples), 45.0);
+}
@@ -0,0 +1,144 @@
+#include "src/gen_wilson_coro.h"
+#include "src/hexmaze.h"
+#include "src/maze_journal.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+template< typename Maze >
+static bool sameEdges(const Maze& m1, const Maze& m2) {
+    for (int id = 0; id < m1.nodeCount(); id++) {
+        const auto node = m1.nodeFromId(id);
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            if (m1.getEdge(node, edge) != m2.getEdge(node, edge)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The maze and the counters are the same as those of CreateMazeWilson, for any yield interval
+TEST(GenWilsonCoroTest, SameMazeAsSequential) {
+    for (unsigned seed = 0; seed < 5; seed++) {
+        HexMaze m1(15, 20);
+        m1.AddExits();
+        CreateMazeWilson<HexMaze> maze_gen(seed);
+        ASSERT_EQ(maze_gen.createMaze(m1), ECreateMazeResult::Ok);
+
+        for (const auto yield_steps : {0LL, 1LL, 97LL}) {
+            HexMaze m2(15, 20);
+            m2.AddExits();
+            auto task = createMazeWilsonSteps(m2, seed, yield_steps);
+            while (task.resume()) {
+            }
+            ASSERT_EQ(task.result(), ECreateMazeResult::Ok);
+            EXPECT_EQ(task.progress().wilson_steps, maze_gen.stats().wilson_steps);
+            EXPECT_EQ(task.progress().wilson_walks, maze_gen.stats().wilson_walks);
+            EXPECT_TRUE(isSpanningTree(m2, 6));
+            EXPECT_TRUE(sameEdges(m1, m2)) << seed << ", " << yield_steps;
+        }
+    }
+}
+
+// Nothing runs before the first resume, then there is a yield after each walk or every N steps
+TEST(GenWilsonCoroTest, YieldPoints) {
+    SquareMaze m1(10, 12);
+    auto task1 = createMazeWilsonSteps(m1, 1, 0);
+    EXPECT_FALSE(task1.done());
+    EXPECT_EQ(m1.getNode({0, 0}), ENode::Open);
+    auto walks = 0;
+    while (task1.resume()) {
+        walks++;
+        EXPECT_EQ(task1.progress().wilson_walks, walks);
+    }
+    EXPECT_TRUE(task1.done());
+    EXPECT_EQ(task1.progress().wilson_walks, walks);
+    EXPECT_FALSE(task1.resume());
+
+    SquareMaze m2(10, 12);
+    auto task2 = createMazeWilsonSteps(m2, 1, 10);
+    auto yields = 0LL;
+    while (task2.resume()) {
+        yields++;
+        EXPECT_EQ(task2.progress().wilson_steps, 10 * yields);
+    }
+    EXPECT_EQ(task2.progress().wilson_steps / 10, yields);
+    EXPECT_TRUE(sameEdges(m1, m2));
+}
+
+// Generations resumed in turns by one thread are the same as the ones run alone, and an abandoned one
+// just stops
+TEST(GenWilsonCoroTest, Interleaved) {
+    std::vector<std::unique_ptr<SquareMaze>> mazes;
+    std::vector<MazeGenerationTask> tasks;
+    for (unsigned seed = 0; seed < 4; seed++) {
+        mazes.push_back(std::make_unique<SquareMaze>(8, 9));
+        tasks.push_back(createMazeWilsonSteps(*mazes.back(), seed, 5));
+    }
+    for (auto running = true; running;) {
+        running = false;
+        for (auto& task : tasks) {
+            running = task.resume() || running;
+        }
+    }
+
+    for (unsigned seed = 0; seed < 4; seed++) {
+        SquareMaze m(8, 9);
+        CreateMazeWilson<SquareMaze> maze_gen(seed);
+        ASSERT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+        EXPECT_EQ(tasks[seed].result(), ECreateMazeResult::Ok);
+        EXPECT_TRUE(sameEdges(*mazes[seed], m)) << seed;
+    }
+
+    SquareMaze abandoned(8, 9);
+    auto task = createMazeWilsonSteps(abandoned, 0, 3);
+    EXPECT_TRUE(task.resume());
+    task = createMazeWilsonSteps(abandoned, 0, 3);
+}
+
+TEST(GenWilsonCoroTest, NoFirstOpenNode) {
+    SquareMaze m(1, 1);
+    m.setNode({0, 0}, ENode::Visited);
+    auto task = createMazeWilsonSteps(m, 0, 0);
+    EXPECT_FALSE(task.resume());
+    EXPECT_EQ(task.result(), ECreateMazeResult::ErrNoFirstOpenNode);
+}
+
+// The changes reported to the observer replay the generation, like the ones of CreateMazeWilsonArrows
+TEST(GenWilsonCoroTest, Observer) {
+    SquareMaze m(10, 12);
+    MazeJournal journal;
+    auto task = createMazeWilsonSteps(m, 2, 7, JournalRecorder<SquareMaze>(journal, m));
+    while (task.resume()) {
+    }
+    ASSERT_EQ(task.result(), ECreateMazeResult::Ok);
+    EXPECT_EQ(journal.changeCount(), 2 * m.nodeCount() - 1);
+
+    SquareMaze replay(10, 12);
+    MazeJournalReplayer<SquareMaze> replayer(journal, replay, 100);
+    EXPECT_TRUE(sameEdges(replay, m));
+}
+
+// A moved-from task is empty, it is done and cannot be resumed
+TEST(GenWilsonCoroTest, MovedFrom) {
+    SquareMaze m(4, 4);
+    auto task = createMazeWilsonSteps(m, 0, 1);
+    EXPECT_TRUE(task.resume());
+    auto moved = std::move(task);
+    EXPECT_FALSE(task.valid());
+    EXPECT_TRUE(task.done());
+    EXPECT_FALSE(task.resume());
+    EXPECT_EQ(task.progress().wilson_steps, 0);
+
+    EXPECT_TRUE(moved.valid());
+    EXPECT_EQ(moved.progress().wilson_steps, 1);
+    while (moved.resume()) {
+    }
+    EXPECT_EQ(moved.result(), ECreateMazeResult::Ok);
+    EXPECT_TRUE(isSpanningTree(m, 4));
+}
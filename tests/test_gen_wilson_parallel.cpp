@@ -0,0 +1,70 @@
+#include "src/gen_wilson_parallel.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+// All nodes are added to the maze and they form a tree
+TEST(GenWilsonParallelTest, CreatesSpanningTree) {
+    for (const auto num_threads : {1, 2, 4, 8}) {
+        HexMaze m(20, 30);
+        CreateMazeWilsonParallel<HexMaze> maze_gen(num_threads, num_threads);
+        EXPECT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+        EXPECT_EQ(m.getOpenNode(), HexMaze::invalidNode());
+        EXPECT_TRUE(isSpanningTree(m, 6));
+    }
+}
+
+// Nodes already in the maze are kept, invalid nodes are not entered
+TEST(GenWilsonParallelTest, ExtendsExistingTree) {
+    SquareMaze m(10, 10);
+    m.invalidateRegion({4, 4}, {5, 5});
+    m.setNode({0, 0}, ENode::Visited);
+
+    CreateMazeWilsonParallel<SquareMaze> maze_gen(0, 4);
+    EXPECT_EQ(maze_gen.createMaze(m), ECreateMazeResult::Ok);
+    EXPECT_EQ(m.getOpenNode(), SquareMaze::invalidNode());
+    EXPECT_EQ(m.getNode({4, 4}), ENode::Invalid);
+    EXPECT_EQ(m.getNode({3, 4}), ENode::Visited);
+    EXPECT_NE(m.getEdge({3, 4}, 1), EEdge::Visited);
+}
+
+// No open node at the first step is an error
+TEST(GenWilsonParallelTest, NoFirstOpenNode) {
+    SquareMaze m(1, 1);
+    m.setNode({0, 0}, ENode::Visited);
+
+    CreateMazeWilsonParallel<SquareMaze> maze_gen(0, 2);
+    EXPECT_EQ(maze_gen.createMaze(m), ECreateMazeResult::ErrNoFirstOpenNode);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+// A 2x3 grid has 15 spanning trees. Both generators must produce all of them with the same probability.
+// With 14 degrees of freedom the statistic exceeds 45 with a probability of less than 0.01%.
+TEST(GenWilsonParallelTest, UniformLikeSequential) {
+    const auto samples = 6000;
+    const auto trees = 15;
+
+    std::map<int, int> sequential;
+    std::map<int, int> parallel;
+    for (int seed = 0; seed < samples; seed++) {
+        SquareMaze m1(2, 3);
+        CreateMazeWilson<SquareMaze> gen1(seed);
+        ASSERT_EQ(gen1.createMaze(m1), ECreateMazeResult::Ok);
+        sequential[treeKey(m1)]++;
+
+        SquareMaze m2(2, 3);
+        CreateMazeWilsonParallel<SquareMaze> gen2(seed, 3);
+        ASSERT_EQ(gen2.createMaze(m2), ECreateMazeResult::Ok);
+        parallel[treeKey(m2)]++;
+    }
+
+    EXPECT_EQ(sequential.size(), trees);
+    EXPECT_EQ(parallel.size(), trees);
+    EXPECT_LT(chiSquared(sequential, trees, samples), 45.0);
+    EXPECT_LT(chiSquared(parallel, trees, samples), 45.0);
+}
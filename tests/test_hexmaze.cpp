@@ -214,4 +214,27 @@ TEST(HexMazeTest, InvalidRegionTest) {
     m.getOpenEdges({1, 1}, edges); EXPECT_EQ(edges, HexMaze::EdgeList({}));
 }
 
+// The open edge masks follow every edge change, during generation as well
+TEST(HexMazeTest, OpenEdgeMaskMatchesEdges) {
+    HexMaze m(5, 6);
+    m.invalidateRegion({1, 1}, {2, 2});
+    m.AddExits();
+    CreateMazeParams params;
+    params.random_seed = 7;
+    ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 6; j++) {
+            EdgeMask expected = 0;
+            for (int e = 1; e <= 6; e++) {
+                const auto state = m.getEdge({i, j}, e);
+                if (state == EEdge::Open || state == EEdge::OnPath) {
+                    expected |= 1 << e;
+                }
+            }
+            EXPECT_EQ(m.getOpenEdgeMask({i, j}), expected) << i << ", " << j;
+        }
+    }
+}
+
 // TODO: Test drawing
@@ -0,0 +1,87 @@
+#include "src/matrix.h"
+
+#include <gtest/gtest.h>
+
+// All entries are zero initially
+TEST(PackedMatrixTest, ZeroInitialized) {
+    PackedMatrix<2> m(5, 7);
+    EXPECT_EQ(m.rows(), 5);
+    EXPECT_EQ(m.cols(), 7);
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 7; j++) {
+            EXPECT_EQ(m[i][j], 0);
+        }
+    }
+}
+
+// Writing an entry does not change its neighbours, including the ones in other words and rows
+TEST(PackedMatrixTest, EntriesAreIndependent) {
+    PackedMatrix<2> m(3, 45);
+    const auto& cm = m;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 45; j++) {
+            m[i][j] = (i + j) % 4;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 45; j++) {
+            EXPECT_EQ(cm[i][j], (i + j) % 4) << i << " " << j;
+        }
+    }
+
+    m[1][31] = 0;
+    m[1][32] = 3;
+    EXPECT_EQ(cm[1][30], (1 + 30) % 4);
+    EXPECT_EQ(cm[1][31], 0);
+    EXPECT_EQ(cm[1][32], 3);
+    EXPECT_EQ(cm[1][33], (1 + 33) % 4);
+}
+
+// clear() sets every entry to 0
+TEST(PackedMatrixTest, Clear) {
+    PackedMatrix<2> m(3, 45);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 45; j++) {
+            m[i][j] = 3;
+        }
+    }
+    m.clear();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 45; j++) {
+            EXPECT_EQ(m[i][j], 0);
+        }
+    }
+}
+
+// Entries can be copied through the proxies
+TEST(PackedMatrixTest, AssignEntry) {
+    PackedMatrix<2> m(2, 2);
+    m[0][0] = 2;
+    m[1][1] = m[0][0];
+    EXPECT_EQ(m[1][1], 2);
+    EXPECT_EQ(m[0][0], 2);
+    const int value = m[1][1];
+    EXPECT_EQ(value, 2);
+}
+
+// Other entry sizes work too
+TEST(PackedMatrixTest, OtherBits) {
+    PackedMatrix<1> m1(1, 100);
+    PackedMatrix<4> m4(1, 100);
+    for (int j = 0; j < 100; j++) {
+        m1[0][j] = j % 2;
+        m4[0][j] = j % 16;
+    }
+    for (int j = 0; j < 100; j++) {
+        EXPECT_EQ(m1[0][j], j % 2);
+        EXPECT_EQ(m4[0][j], j % 16);
+    }
+}
+
+// 2 bits per entry, rounded up to whole words
+TEST(PackedMatrixTest, MemoryUsage) {
+    EXPECT_EQ(PackedMatrix<2>(1, 1).memoryUsage(), 8u);
+    EXPECT_EQ(PackedMatrix<2>(2, 16).memoryUsage(), 8u);
+    EXPECT_EQ(PackedMatrix<2>(3, 16).memoryUsage(), 16u);
+    EXPECT_EQ(PackedMatrix<2>(1000, 1000).memoryUsage(), 1000u * 1000u / 4);
+}
@@ -0,0 +1,201 @@
+#include "src/maze_journal.h"
+#include "src/hexmaze.h"
+#include "src/maze_solver.h"
+#include "src/square_maze.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool operator==(const MazeChange& lhs, const MazeChange& rhs) {
+    return lhs.node_id == rhs.node_id && lhs.edge == rhs.edge && lhs.state == rhs.state;
+}
+
+// State of all nodes and edges, exits included
+template< typename Maze >
+static std::vector<int> mazeStates(const Maze& m) {
+    std::vector<int> states;
+    for (int id = 0; id < m.nodeCount(); id++) {
+        const auto node = m.nodeFromId(id);
+        states.push_back(static_cast<int>(m.getNode(node)));
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            states.push_back(static_cast<int>(m.getEdge(node, edge)));
+        }
+    }
+    return states;
+}
+
+// The changes are decoded as they were appended, with large and negative differences of the node ids
+TEST(MazeJournalTest, EncodeDecode) {
+    const std::vector<MazeChange> changes = {
+        {0, 0, 1}, {1, 3, 2}, {1, 0, 2}, {0, 7, 0}, {1000000, 6, 1}, {999000, 1, 3}, {0, 0, 0}, {2000000000, 2, 1}};
+    MazeJournal journal;
+    for (const auto& change : changes) {
+        journal.append(change);
+    }
+    EXPECT_EQ(journal.changeCount(), static_cast<long long>(changes.size()));
+
+    MazeJournal::Position pos;
+    for (const auto& expected : changes) {
+        MazeChange change;
+        ASSERT_TRUE(journal.read(pos, change));
+        EXPECT_TRUE(change == expected) << change.node_id << " " << change.edge << " " << change.state;
+    }
+    MazeChange change;
+    EXPECT_FALSE(journal.read(pos, change));
+}
+
+// Saved journals are loaded as they were, other data is rejected
+TEST(MazeJournalTest, SaveLoad) {
+    MazeJournal journal;
+    for (int k = 0; k < 1000; k++) {
+        journal.append({(k * 37) % 500, k % 7, k % 3});
+    }
+    std::stringstream ss;
+    ASSERT_TRUE(journal.save(ss));
+    const auto saved = ss.str();
+
+    MazeJournal loaded;
+    ASSERT_TRUE(loaded.load(ss));
+    EXPECT_EQ(loaded.changeCount(), journal.changeCount());
+    EXPECT_EQ(loaded.byteCount(), journal.byteCount());
+    MazeJournal::Position pos1;
+    MazeJournal::Position pos2;
+    MazeChange change1;
+    MazeChange change2;
+    while (journal.read(pos1, change1)) {
+        ASSERT_TRUE(loaded.read(pos2, change2));
+        EXPECT_TRUE(change1 == change2);
+    }
+
+    // Appending goes on from the last change
+    journal.append({7, 1, 1});
+    loaded.append({7, 1, 1});
+    EXPECT_EQ(loaded.byteCount(), journal.byteCount());
+
+    std::stringstream truncated(saved.substr(0, saved.size() - 1));
+    EXPECT_FALSE(loaded.load(truncated));
+    EXPECT_EQ(loaded.changeCount(), 0);
+    std::stringstream other("<svg></svg>");
+    EXPECT_FALSE(loaded.load(other));
+}
+
+// The byte count of the header is checked against the data, a huge one does not allocate it
+TEST(MazeJournalTest, LoadHugeSize) {
+    // 1 change, 2^62 and 2^64 - 1 bytes, and a single byte of data
+    const char* sizes[] = {"\x80\x80\x80\x80\x80\x80\x80\x80\x40", "\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01"};
+    for (const auto* size : sizes) {
+        std::stringstream ss(std::string("MZJ1\x01") + size + "\x08");
+        MazeJournal journal;
+        EXPECT_FALSE(journal.load(ss));
+        EXPECT_EQ(journal.changeCount(), 0);
+        EXPECT_EQ(journal.byteCount(), 0u);
+    }
+}
+
+// The last frame of the replay is the generated maze, and any frame can be reached from any other one
+TEST(MazeJournalTest, RecordAndReplay) {
+    HexMaze m(15, 20);
+    m.invalidateRegion({5, 5}, {8, 9});
+    m.AddExits();
+    CreateMazeParams params;
+    params.random_seed = 4;
+    MazeJournal journal;
+    ASSERT_EQ(m.RecordMaze(params, nullptr, journal), ECreateMazeResult::Ok);
+    // Every node is set on the path and then visited at least
+    EXPECT_GT(journal.changeCount(), 2 * m.nodeCount());
+
+    HexMaze replay(15, 20);
+    replay.invalidateRegion({5, 5}, {8, 9});
+    replay.AddExits();
+    const auto initial = mazeStates(replay);
+    MazeJournalReplayer<HexMaze> replayer(journal, replay, 500);
+    EXPECT_EQ(replayer.frame(), journal.changeCount());
+    EXPECT_GT(replayer.keyframeCount(), 2);
+    EXPECT_EQ(mazeStates(replay), mazeStates(m));
+
+    // Reference frames, replayed from the start without keyframes
+    HexMaze reference(15, 20);
+    reference.invalidateRegion({5, 5}, {8, 9});
+    reference.AddExits();
+    MazeJournalReplayer<HexMaze> reference_replayer(journal, reference, journal.changeCount() + 1);
+    std::vector<long long> frames;
+    std::vector<std::vector<int>> states;
+    for (long long frame = 0; frame <= journal.changeCount(); frame += 333) {
+        reference_replayer.seek(frame);
+        frames.push_back(frame);
+        states.push_back(mazeStates(reference));
+    }
+
+    replayer.seek(0);
+    EXPECT_EQ(mazeStates(replay), initial);
+    for (const auto k : {3, 1, 7, 7, 0, 5, 2, 6, 4}) {
+        const auto index = static_cast<size_t>(k) % frames.size();
+        replayer.seek(frames[index]);
+        EXPECT_EQ(replayer.frame(), frames[index]);
+        EXPECT_EQ(mazeStates(replay), states[index]) << frames[index];
+    }
+    replayer.seek(journal.changeCount() + 100);
+    EXPECT_EQ(mazeStates(replay), mazeStates(m));
+}
+
+// The longest path exits are opened after the maze is generated, the replay ends with them too. Seeking
+// back before them closes the walls to the outside again.
+TEST(MazeJournalTest, RecordLongestPathExits) {
+    HexMaze m(12, 16);
+    CreateMazeParams params;
+    params.random_seed = 2;
+    MazeJournal journal;
+    ASSERT_EQ(m.RecordMaze(params, nullptr, journal), ECreateMazeResult::Ok);
+    const auto change_count = journal.changeCount();
+    m.RecordLongestPathExits(journal);
+    EXPECT_EQ(journal.changeCount(), change_count + 2);
+
+    HexMaze replay(12, 16);
+    const auto initial = mazeStates(replay);
+    MazeJournalReplayer<HexMaze> replayer(journal, replay, 100);
+    EXPECT_EQ(mazeStates(replay), mazeStates(m));
+    std::vector<HexMaze::NodeIndex> path;
+    EXPECT_TRUE(MazeSolver<HexMaze>().solve(replay, path));
+
+    replayer.seek(0);
+    EXPECT_EQ(mazeStates(replay), initial);
+    replayer.seek(journal.changeCount());
+    EXPECT_EQ(mazeStates(replay), mazeStates(m));
+}
+
+// The regeneration of a region is recorded after the maze, the replay ends on the regenerated maze.
+// Seeking back to the end of the generation restores the maze before the regeneration.
+TEST(MazeJournalTest, RecordRegenerateRegion) {
+    SquareMaze m(12, 16);
+    CreateMazeParams params;
+    params.random_seed = 4;
+    MazeJournal journal;
+    ASSERT_EQ(m.RecordMaze(params, nullptr, journal), ECreateMazeResult::Ok);
+    const auto change_count = journal.changeCount();
+    const auto generated = mazeStates(m);
+    CreateMazeStats stats;
+    m.RecordRegenerateRegion({2, 3}, {9, 12}, 7, &stats, journal);
+    EXPECT_GT(stats.wilson_walks, 0);
+    EXPECT_GT(journal.changeCount(), change_count);
+    ASSERT_NE(mazeStates(m), generated);
+
+    SquareMaze replay(12, 16);
+    MazeJournalReplayer<SquareMaze> replayer(journal, replay, 100);
+    EXPECT_EQ(mazeStates(replay), mazeStates(m));
+
+    replayer.seek(change_count);
+    EXPECT_EQ(mazeStates(replay), generated);
+    replayer.seek(journal.changeCount());
+    EXPECT_EQ(mazeStates(replay), mazeStates(m));
+}
+
+// The walks move between adjacent cells, so the changes take less than two bytes on average
+TEST(MazeJournalTest, Compact) {
+    SquareMaze m(100, 120);
+    MazeJournal journal;
+    ASSERT_EQ(m.RecordMaze({}, nullptr, journal), ECreateMazeResult::Ok);
+    EXPECT_LT(journal.byteCount(), 2 * static_cast<size_t>(journal.changeCount()));
+}
@@ -0,0 +1,94 @@
+#include "src/maze_metrics.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+// A single corridor between the exits
+TEST(MazeMetricsTest, Corridor) {
+    SquareMaze m(1, 4);
+    buildMaze(m, {{{0, 0}, 2}, {{0, 1}, 2}, {{0, 2}, 2}});
+    m.AddExits();
+
+    const auto metrics = computeMazeMetrics(m);
+    EXPECT_EQ(metrics.cells, 4);
+    EXPECT_EQ(metrics.solution_length, 4);
+    EXPECT_EQ(metrics.dead_ends, 0);
+    EXPECT_EQ(metrics.junctions, 0);
+    EXPECT_EQ(metrics.branching_factor, 0.0);
+    EXPECT_EQ(metrics.river, 0.0);
+    EXPECT_EQ(metrics.longest_corridor, 4);
+}
+
+// The top row with a column hanging from each of its cells:
+//   E---+---+
+//   |   |   |
+//   +   +   +
+//   |   |   |
+//   D   D   E
+TEST(MazeMetricsTest, Comb) {
+    SquareMaze m(3, 3);
+    buildMaze(m, {{{0, 0}, 2}, {{0, 1}, 2},
+                  {{0, 0}, 1}, {{1, 0}, 1},
+                  {{0, 1}, 1}, {{1, 1}, 1},
+                  {{0, 2}, 1}, {{1, 2}, 1}});
+    m.AddExits();
+
+    const auto metrics = computeMazeMetrics(m);
+    EXPECT_EQ(metrics.cells, 9);
+    EXPECT_EQ(metrics.solution_length, 5);
+    EXPECT_EQ(metrics.dead_ends, 2);
+    EXPECT_EQ(metrics.junctions, 2);
+    EXPECT_EQ(metrics.branching_factor, 2.0);
+    EXPECT_EQ(metrics.river, 2.0);
+    EXPECT_EQ(metrics.longest_corridor, 3);
+}
+
+// A corridor turning at the top left cell, between two dead ends:
+// (1, 1) - (1, 0) - (0, 0) - (0, 1) - (0, 2) - (1, 2)
+TEST(MazeMetricsTest, CorridorBetweenDeadEnds) {
+    SquareMaze m(2, 3);
+    buildMaze(m, {{{1, 0}, 2}, {{0, 0}, 1}, {{0, 0}, 2}, {{0, 1}, 2}, {{0, 2}, 1}});
+
+    const auto metrics = computeMazeMetrics(m);
+    EXPECT_EQ(metrics.solution_length, 0);
+    EXPECT_EQ(metrics.dead_ends, 2);
+    EXPECT_EQ(metrics.river, 5.0);
+    EXPECT_EQ(metrics.longest_corridor, 4);
+}
+
+// The metrics of a generated maze are consistent with its size
+TEST(MazeMetricsTest, GeneratedMaze) {
+    HexMaze m(10, 12);
+    m.AddExits();
+    ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+    ASSERT_TRUE(isSpanningTree(m, HexMaze::EDGE_COUNT));
+
+    const auto metrics = m.ComputeMetrics();
+    EXPECT_GE(metrics.solution_length, 12);
+    EXPECT_LE(metrics.solution_length, 10*12);
+    EXPECT_EQ(metrics.cells, 10*12);
+    EXPECT_GT(metrics.dead_ends, 0);
+    EXPECT_GT(metrics.junctions, 0);
+    EXPECT_GE(metrics.branching_factor, 2.0);
+    EXPECT_GE(metrics.river, 1.0);
+    EXPECT_GT(metrics.longest_corridor, 0);
+    // The maze is a tree: 2 * (cells - 1) tree edge ends and 2 exits
+    EXPECT_LE(metrics.dead_ends + 3*metrics.junctions, 2*(10*12 - 1) + 2);
+}
+
+// Difficulty scores grow with the difficulty
+TEST(MazeMetricsTest, DifficultyScore) {
+    MazeMetrics easy;
+    easy.solution_length = 10;
+    easy.dead_ends = 3;
+    easy.longest_corridor = 8;
+    MazeMetrics hard;
+    hard.solution_length = 20;
+    hard.dead_ends = 6;
+    hard.longest_corridor = 4;
+    for (const auto difficulty : {EDifficulty::SolutionLength, EDifficulty::DeadEnds, EDifficulty::Corridors}) {
+        EXPECT_LT(difficultyScore(easy, difficulty), difficultyScore(hard, difficulty));
+    }
+}
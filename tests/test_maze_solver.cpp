@@ -0,0 +1,221 @@
+#include "src/maze_solver.h"
+#include "src/brick_maze.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+#include "tests/test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using NodeList = std::vector<NodeIndex2D>;
+
+// The path goes from the top left exit to the bottom right one, past the dead ends:
+//   E---+---+
+//   |   |   |
+//   +   +   +
+//   |   |   |
+//   D   D   E
+TEST(MazeSolverTest, FindsPath) {
+    SquareMaze m(3, 3);
+    buildMaze(m, {{{0, 0}, 2}, {{0, 1}, 2},
+                  {{0, 0}, 1}, {{1, 0}, 1},
+                  {{0, 1}, 1}, {{1, 1}, 1},
+                  {{0, 2}, 1}, {{1, 2}, 1}});
+    m.AddExits();
+
+    MazeSolver<SquareMaze> solver;
+    NodeList path;
+    ASSERT_TRUE(solver.solve(m, path));
+    EXPECT_EQ(path, NodeList({{0, 0}, {0, 1}, {0, 2}, {1, 2}, {2, 2}}));
+}
+
+// Both exits of a single cell
+TEST(MazeSolverTest, SingleCell) {
+    SquareMaze m(1, 1);
+    buildMaze(m, {});
+    m.AddExits();
+
+    MazeSolver<SquareMaze> solver;
+    NodeList path;
+    ASSERT_TRUE(solver.solve(m, path));
+    EXPECT_EQ(path, NodeList({{0, 0}}));
+}
+
+// Without exits or a connection between them there is no path
+TEST(MazeSolverTest, NoPath) {
+    SquareMaze m(2, 2);
+    buildMaze(m, {{{0, 0}, 2}, {{1, 0}, 2}});
+
+    MazeSolver<SquareMaze> solver;
+    NodeList path = {{0, 0}};
+    EXPECT_FALSE(solver.solve(m, path));
+    EXPECT_TRUE(path.empty());
+
+    m.AddExits();
+    EXPECT_FALSE(solver.solve(m, path));
+}
+
+// The path of a generated maze connects the exits through adjacent cells, and it is the path left by
+// dead-end filling in the metrics. The solver is reused for all grids.
+template< typename Maze >
+static void checkGeneratedMaze(int rows, int cols) {
+    MazeSolver<Maze> solver;
+    for (unsigned seed = 0; seed < 5; seed++) {
+        Maze m(rows, cols);
+        m.AddExits();
+        CreateMazeParams params;
+        params.random_seed = seed;
+        ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+
+        NodeList path;
+        ASSERT_TRUE(solver.solve(m, path));
+        EXPECT_EQ(path.front(), NodeIndex2D(0, 0));
+        EXPECT_EQ(path.back(), NodeIndex2D(rows - 1, cols - 1));
+        for (size_t k = 1; k < path.size(); k++) {
+            auto adjacent = false;
+            for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+                adjacent = adjacent || (Maze::nextNode(path[k - 1], edge) == path[k] &&
+                                        m.getEdge(path[k - 1], edge) == EEdge::Visited);
+            }
+            EXPECT_TRUE(adjacent) << k;
+        }
+        EXPECT_EQ(static_cast<int>(path.size()), m.ComputeMetrics().solution_length);
+    }
+}
+
+TEST(MazeSolverTest, GeneratedMazes) {
+    checkGeneratedMaze<HexMaze>(12, 15);
+    checkGeneratedMaze<SquareMaze>(12, 15);
+    checkGeneratedMaze<BrickMaze>(12, 15);
+}
+
+// The longest path between border cells of the comb runs from the bottom of the first column to the
+// bottom of the last one
+TEST(MazeSolverTest, LongestPathExits) {
+    SquareMaze m(3, 3);
+    buildMaze(m, {{{0, 0}, 2}, {{0, 1}, 2},
+                  {{0, 0}, 1}, {{1, 0}, 1},
+                  {{0, 1}, 1}, {{1, 1}, 1},
+                  {{0, 2}, 1}, {{1, 2}, 1}});
+
+    MazeSolver<SquareMaze> solver;
+    NodeIndex2D first;
+    NodeIndex2D second;
+    ASSERT_TRUE(solver.findLongestPath(m, first, second));
+    EXPECT_EQ(first.i, 2);
+    EXPECT_EQ(second.i, 2);
+    EXPECT_EQ(first.j + second.j, 2);
+    EXPECT_NE(first.j, second.j);
+
+    m.AddLongestPathExits();
+    NodeList path;
+    ASSERT_TRUE(solver.solve(m, path));
+    EXPECT_EQ(path, NodeList({{2, 0}, {1, 0}, {0, 0}, {0, 1}, {0, 2}, {1, 2}, {2, 2}}));
+}
+
+// Both exits of the only cell are on different walls
+TEST(MazeSolverTest, LongestPathExitsSingleCell) {
+    HexMaze m(1, 1);
+    buildMaze(m, {});
+    m.AddLongestPathExits();
+
+    auto exits = 0;
+    for (int edge = 1; edge <= HexMaze::EDGE_COUNT; edge++) {
+        exits += m.getEdge({0, 0}, edge) == EEdge::Visited ? 1 : 0;
+    }
+    EXPECT_EQ(exits, 2);
+}
+
+// Number of cells on the path between `from` and `to`, by a plain breadth-first search
+template< typename Maze >
+static int pathLength(const Maze& m, NodeIndex2D from, NodeIndex2D to) {
+    std::vector<int> distance(m.nodeCount(), 0);
+    std::vector<NodeIndex2D> queue = {from};
+    distance[m.nodeId(from)] = 1;
+    for (size_t k = 0; k < queue.size(); k++) {
+        const auto node = queue[k];
+        if (node == to) {
+            return distance[m.nodeId(node)];
+        }
+        for (int edge = 1; edge <= Maze::EDGE_COUNT; edge++) {
+            const auto next = Maze::nextNode(node, edge);
+            if (m.getEdge(node, edge) != EEdge::Visited ||
+                next.i < 0 || next.i >= m.rows() || next.j < 0 || next.j >= m.cols()) {
+                continue;
+            }
+            if (distance[m.nodeId(next)] == 0) {
+                distance[m.nodeId(next)] = distance[m.nodeId(node)] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+    return 0;
+}
+
+// The exits added to generated mazes are at the ends of the longest path between border cells, which is
+// at least as long as the path between the corners. All pairs of border cells are compared.
+template< typename Maze >
+static void checkLongestPathExits(int rows, int cols) {
+    for (unsigned seed = 0; seed < 3; seed++) {
+        Maze m(rows, cols);
+        CreateMazeParams params;
+        params.random_seed = seed;
+        ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+
+        std::vector<NodeIndex2D> border;
+        for (int id = 0; id < m.nodeCount(); id++) {
+            const auto node = m.nodeFromId(id);
+            if (node.i == 0 || node.i == rows - 1 || node.j == 0 || node.j == cols - 1) {
+                border.push_back(node);
+            }
+        }
+        auto longest = 0;
+        for (size_t a = 0; a < border.size(); a++) {
+            for (size_t b = a; b < border.size(); b++) {
+                longest = std::max(longest, pathLength(m, border[a], border[b]));
+            }
+        }
+
+        m.AddLongestPathExits();
+        const auto solution_length = m.ComputeMetrics().solution_length;
+        EXPECT_EQ(solution_length, longest);
+        EXPECT_GE(solution_length, pathLength(m, {0, 0}, {rows - 1, cols - 1}));
+    }
+}
+
+TEST(MazeSolverTest, GeneratedLongestPathExits) {
+    checkLongestPathExits<HexMaze>(9, 11);
+    checkLongestPathExits<SquareMaze>(9, 11);
+    checkLongestPathExits<BrickMaze>(9, 11);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+// Counts the lines drawn with the solution style
+class SolutionCounter : public IPainter
+{
+public:
+    void BeginDraw(int, int) override {}
+    void EndDraw() override {}
+    void DrawLine(const Point2D&, const Point2D&, EStyle style) override {
+        lines += style == EStyle::Solution ? 1 : 0;
+    }
+    void DrawPoly(const std::vector<Point2D>&, EStyle) override {}
+
+    int lines = 0;
+};
+
+// The solution is drawn on request, with a line between each pair of cells on the path
+TEST(MazeSolverTest, DrawSolution) {
+    HexMaze m(8, 9);
+    m.AddExits();
+    ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+
+    SolutionCounter painter;
+    m.Draw(painter, {40, 40, 4});
+    EXPECT_EQ(painter.lines, 0);
+
+    m.Draw(painter, {40, 40, 4, true});
+    EXPECT_EQ(painter.lines, m.ComputeMetrics().solution_length - 1);
+}
@@ -0,0 +1,86 @@
+#include "src/open_node_index.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+// All nodes are open initially and they are returned in scan order
+TEST(OpenNodeIndexTest, ScanOrder) {
+    OpenNodeIndex s(5);
+
+    for (int id = 0; id < 5; id++) {
+        EXPECT_TRUE(s.contains(id));
+        EXPECT_EQ(s.first(), id);
+        s.erase(id);
+        EXPECT_FALSE(s.contains(id));
+    }
+    EXPECT_EQ(s.first(), -1);
+}
+
+// Erased nodes can be inserted again and the first node is updated
+TEST(OpenNodeIndexTest, InsertErase) {
+    OpenNodeIndex s(10);
+
+    s.erase(0);
+    s.erase(1);
+    EXPECT_EQ(s.first(), 2);
+    s.insert(1);
+    EXPECT_EQ(s.first(), 1);
+    // Both operations are idempotent
+    s.insert(1);
+    s.erase(0);
+    EXPECT_EQ(s.first(), 1);
+}
+
+// reset() makes all nodes open again
+TEST(OpenNodeIndexTest, Reset) {
+    const auto size = 64*64 + 5;
+    OpenNodeIndex s(size);
+    s.setOrder(EOpenNodeOrder::Random, 3);
+    const auto first = s.first();
+
+    for (int id = 0; id < size; id++) {
+        s.erase(id);
+    }
+    s.reset();
+    for (int id = 0; id < size; id++) {
+        EXPECT_TRUE(s.contains(id));
+    }
+    // The order is kept
+    EXPECT_EQ(s.first(), first);
+}
+
+// The hierarchy works across word boundaries on multiple levels
+TEST(OpenNodeIndexTest, MultipleLevels) {
+    const auto size = 64*64*3 + 5;
+    OpenNodeIndex s(size);
+
+    for (int id = 0; id < size - 1; id++) {
+        s.erase(id);
+    }
+    EXPECT_EQ(s.first(), size - 1);
+    s.insert(64*64 + 7);
+    EXPECT_EQ(s.first(), 64*64 + 7);
+    s.erase(64*64 + 7);
+    s.erase(size - 1);
+    EXPECT_EQ(s.first(), -1);
+}
+
+// In random order each node is returned exactly once, the set of open nodes is preserved
+TEST(OpenNodeIndexTest, RandomOrder) {
+    const auto size = 200;
+    OpenNodeIndex s(size);
+    s.erase(7);
+    s.setOrder(EOpenNodeOrder::Random, 42);
+    EXPECT_FALSE(s.contains(7));
+
+    std::vector<int> order;
+    for (auto id = s.first(); id >= 0; id = s.first()) {
+        order.push_back(id);
+        s.erase(id);
+    }
+    EXPECT_EQ(order.size(), size - 1);
+    EXPECT_EQ(std::set<int>(order.begin(), order.end()).size(), size - 1);
+    EXPECT_TRUE(std::find(order.begin(), order.end(), 7) == order.end());
+    EXPECT_FALSE(std::is_sorted(order.begin(), order.end()));
+}
@@ -0,0 +1,272 @@
+#include "src/png_painter.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+static uint32_t readBigEndian(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xffffffffu;
+    for (size_t k = 0; k < size; k++) {
+        crc ^= data[k];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+        }
+    }
+    return crc ^ 0xffffffffu;
+}
+
+// Decoder of the zlib streams of PngPainter: a single block with the fixed Huffman codes
+class Inflater
+{
+public:
+    explicit Inflater(const std::vector<uint8_t>& data): data_(data) {}
+
+    bool inflate(std::vector<uint8_t>& out) {
+        static const int LENGTH_BASE[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67,
+                                          83, 99, 115, 131, 163, 195, 227, 258};
+        static const int LENGTH_EXTRA[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5,
+                                           5, 5, 0};
+        static const int DISTANCE_BASE[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+                                            769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const int DISTANCE_EXTRA[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+                                             11, 11, 12, 12, 13, 13};
+        if (data_.size() < 6 || (data_[0] * 256 + data_[1]) % 31 != 0 || (data_[0] & 0x0f) != 8) {
+            return false;
+        }
+        pos_ = 16;
+        // Last block with the fixed codes
+        if (bits(1) != 1 || bits(2) != 1) {
+            return false;
+        }
+        for (;;) {
+            const auto symbol = literalLength();
+            if (symbol < 256) {
+                out.push_back(static_cast<uint8_t>(symbol));
+            } else if (symbol == 256) {
+                break;
+            } else if (symbol <= 285) {
+                const auto length = LENGTH_BASE[symbol - 257] + bits(LENGTH_EXTRA[symbol - 257]);
+                const auto distance_code = code(5);
+                if (distance_code >= 30) {
+                    return false;
+                }
+                const auto distance = static_cast<size_t>(DISTANCE_BASE[distance_code] + bits(DISTANCE_EXTRA[distance_code]));
+                if (distance > out.size()) {
+                    return false;
+                }
+                for (int k = 0; k < length; k++) {
+                    out.push_back(out[out.size() - distance]);
+                }
+            } else {
+                return false;
+            }
+            if (pos_ > 8 * data_.size()) {
+                return false;
+            }
+        }
+
+        // Adler-32 of the data, after the last byte of the block
+        const auto end = (pos_ + 7) / 8;
+        if (end + 4 != data_.size()) {
+            return false;
+        }
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (const auto byte : out) {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        return readBigEndian(&data_[end]) == (b << 16 | a);
+    }
+
+private:
+    int bit() {
+        const auto byte = pos_ / 8 < data_.size() ? data_[pos_ / 8] : 0;
+        const auto value = byte >> (pos_ % 8) & 1;
+        pos_++;
+        return value;
+    }
+    int bits(int count) {
+        auto value = 0;
+        for (int k = 0; k < count; k++) {
+            value |= bit() << k;
+        }
+        return value;
+    }
+    // Huffman codes start from their most significant bit
+    int code(int count) {
+        auto value = 0;
+        for (int k = 0; k < count; k++) {
+            value = value << 1 | bit();
+        }
+        return value;
+    }
+    int literalLength() {
+        auto c = code(7);
+        if (c <= 23) {
+            return 256 + c;
+        }
+        c = c << 1 | bit();
+        if (c >= 0x30 && c <= 0xbf) {
+            return c - 0x30;
+        }
+        if (c >= 0xc0 && c <= 0xc7) {
+            return 280 + c - 0xc0;
+        }
+        c = c << 1 | bit();
+        return 144 + c - 0x190;
+    }
+
+    const std::vector<uint8_t>& data_;
+    size_t pos_ = 0;
+};
+
+// Decodes a PNG written by PngPainter and checks its pixels against the painter's
+static void expectDecodedImage(const PngPainter& painter) {
+    std::ostringstream os;
+    painter.Write(os);
+    const auto png = os.str();
+    const auto* data = reinterpret_cast<const uint8_t*>(png.data());
+    ASSERT_EQ(png.substr(0, 8), "\x89PNG\r\n\x1a\n");
+
+    std::vector<std::string> types;
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> idat;
+    for (size_t pos = 8; pos < png.size();) {
+        ASSERT_LE(pos + 12, png.size());
+        const auto length = readBigEndian(data + pos);
+        ASSERT_LE(pos + 12 + length, png.size());
+        types.push_back(png.substr(pos + 4, 4));
+        EXPECT_EQ(readBigEndian(data + pos + 8 + length), crc32(data + pos + 4, 4 + length)) << types.back();
+        auto& chunk = types.back() == "IHDR" ? header : idat;
+        chunk.insert(chunk.end(), data + pos + 8, data + pos + 8 + length);
+        pos += 12 + length;
+    }
+    ASSERT_EQ(types, std::vector<std::string>({"IHDR", "IDAT", "IEND"}));
+    ASSERT_EQ(header.size(), 13u);
+    EXPECT_EQ(readBigEndian(&header[0]), static_cast<uint32_t>(painter.width()));
+    EXPECT_EQ(readBigEndian(&header[4]), static_cast<uint32_t>(painter.height()));
+    EXPECT_EQ(header[8], 8);
+    EXPECT_EQ(header[9], painter.bytesPerPixel() == 1 ? 0 : 6);
+
+    std::vector<uint8_t> rows;
+    ASSERT_TRUE(Inflater(idat).inflate(rows));
+    const auto row_size = static_cast<size_t>(painter.width() * painter.bytesPerPixel());
+    ASSERT_EQ(rows.size(), (row_size + 1) * painter.height());
+    for (int y = 0; y < painter.height(); y++) {
+        const auto* row = &rows[y * (row_size + 1)];
+        ASSERT_EQ(row[0], 0);
+        ASSERT_TRUE(std::equal(row + 1, row + 1 + row_size, painter.pixel(0, y))) << y;
+    }
+    // The repeats of a maze image are most of it
+    if (rows.size() > 10000) {
+        EXPECT_LT(idat.size() * 4, rows.size());
+    }
+}
+
+// The pixels whose center is in a polygon or within the stroke radius of a line are filled
+TEST(PngPainterTest, Aliased) {
+    PngPainter painter({4}, EPixelFormat::Gray, false);
+    painter.BeginDraw(40, 30);
+    painter.DrawPoly({{0, 0}, {10, 0}, {10, 10}, {0, 10}}, IPainter::EStyle::OpenCell);
+    painter.DrawLine({20, 0}, {20, 20}, IPainter::EStyle::Wall);
+    painter.EndDraw();
+
+    EXPECT_EQ(*painter.pixel(0, 0), 169);
+    EXPECT_EQ(*painter.pixel(9, 9), 169);
+    EXPECT_EQ(*painter.pixel(10, 5), 255);
+    EXPECT_EQ(*painter.pixel(5, 10), 255);
+    for (int x = 17; x <= 22; x++) {
+        EXPECT_EQ(*painter.pixel(x, 10), x >= 18 && x <= 21 ? 0 : 255) << x;
+    }
+    // Round cap
+    EXPECT_EQ(*painter.pixel(20, 21), 0);
+    EXPECT_EQ(*painter.pixel(18, 21), 255);
+    EXPECT_EQ(*painter.pixel(20, 22), 255);
+    expectDecodedImage(painter);
+}
+
+TEST(PngPainterTest, Rgba) {
+    PngPainter painter({2}, EPixelFormat::Rgba, false);
+    painter.BeginDraw(20, 20);
+    painter.DrawLine({0, 10}, {20, 10}, IPainter::EStyle::Solution);
+    painter.DrawPoly({{0, 0}, {5, 0}, {5, 5}, {0, 5}}, IPainter::EStyle::WallBlocked);
+    painter.EndDraw();
+
+    const uint8_t blue[] = {0, 0, 255, 255};
+    const uint8_t red[] = {255, 0, 0, 255};
+    const uint8_t white[] = {255, 255, 255, 255};
+    EXPECT_TRUE(std::equal(blue, blue + 4, painter.pixel(7, 9)));
+    EXPECT_TRUE(std::equal(blue, blue + 4, painter.pixel(7, 10)));
+    EXPECT_TRUE(std::equal(white, white + 4, painter.pixel(7, 11)));
+    EXPECT_TRUE(std::equal(red, red + 4, painter.pixel(4, 4)));
+    EXPECT_TRUE(std::equal(white, white + 4, painter.pixel(5, 4)));
+    expectDecodedImage(painter);
+}
+
+// Edge pixels are blended by how much of them is covered
+TEST(PngPainterTest, Antialiased) {
+    PngPainter painter({1}, EPixelFormat::Gray, true);
+    painter.BeginDraw(30, 20);
+    painter.DrawPoly({{0, 0}, {10, 0}, {0, 10}}, IPainter::EStyle::Wall);
+    painter.DrawLine({20, 2}, {20, 18}, IPainter::EStyle::Wall);
+    painter.EndDraw();
+
+    EXPECT_EQ(*painter.pixel(2, 2), 0);
+    EXPECT_EQ(*painter.pixel(8, 8), 255);
+    // Half of the pixel is under the diagonal
+    EXPECT_NEAR(*painter.pixel(4, 5), 128, 10);
+    // A line of width 1 on the border of two pixels covers half of each
+    EXPECT_NEAR(*painter.pixel(19, 10), 128, 2);
+    EXPECT_NEAR(*painter.pixel(20, 10), 128, 2);
+    EXPECT_EQ(*painter.pixel(18, 10), 255);
+    EXPECT_EQ(*painter.pixel(21, 10), 255);
+    expectDecodedImage(painter);
+}
+
+// Elements out of the image are clipped
+TEST(PngPainterTest, Clipping) {
+    PngPainter painter({6}, EPixelFormat::Rgba, true);
+    painter.BeginDraw(10, 10);
+    painter.DrawLine({-20, 5}, {30, 5}, IPainter::EStyle::Wall);
+    painter.DrawPoly({{-5, -5}, {15, -5}, {15, 2}, {-5, 2}}, IPainter::EStyle::OpenCell);
+    painter.DrawLine({5, 5}, {5, 5}, IPainter::EStyle::Solution);
+    painter.EndDraw();
+    EXPECT_EQ(painter.pixel(0, 0)[0], 169);
+    EXPECT_EQ(painter.pixel(9, 1)[0], 169);
+    EXPECT_EQ(painter.pixel(0, 5)[0], 0);
+    EXPECT_EQ(painter.pixel(9, 5)[0], 0);
+    // A dot
+    EXPECT_EQ(painter.pixel(5, 5)[2], 255);
+    expectDecodedImage(painter);
+}
+
+TEST(PngPainterTest, Mazes) {
+    for (const auto format : {EPixelFormat::Gray, EPixelFormat::Rgba}) {
+        for (const auto antialias : {false, true}) {
+            HexMaze hex(12, 15);
+            hex.AddExits();
+            ASSERT_EQ(hex.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+            PngPainter hex_painter({3}, format, antialias);
+            hex.Draw(hex_painter, {20, 20, 3, true});
+            expectDecodedImage(hex_painter);
+
+            SquareMaze square(12, 15);
+            square.AddExits();
+            ASSERT_EQ(square.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+            PngPainter square_painter({4}, format, antialias);
+            square.Draw(square_painter, {16, 16, 4, true});
+            expectDecodedImage(square_painter);
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#include "src/polyline_painter.h"
+#include "src/brick_maze.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include <vector>
+
+// Collects the lines and the polylines drawn
+class LineCollector : public IPainter
+{
+public:
+    void BeginDraw(int, int) override {}
+    void EndDraw() override {}
+    void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) override {
+        lines.push_back({{p1, p2}, style});
+    }
+    void DrawPoly(const std::vector<Point2D>&, EStyle) override {
+        polys++;
+    }
+    void DrawPolyline(const std::vector<Point2D>& vertices, EStyle style) override {
+        polylines.push_back({vertices, style});
+    }
+
+    struct Line
+    {
+        Segment segment;
+        EStyle style;
+    };
+    struct Polyline
+    {
+        std::vector<Point2D> vertices;
+        EStyle style;
+    };
+    std::vector<Line> lines;
+    std::vector<Polyline> polylines;
+    int polys = 0;
+};
+
+static double length(const Point2D& p1, const Point2D& p2) {
+    return hypot(p2.x - p1.x, p2.y - p1.y);
+}
+
+// Whether `p` is on the segment from `a` to `b`
+static bool isOnSegment(const Point2D& p, const Point2D& a, const Point2D& b) {
+    const auto cross = static_cast<long long>(b.x - a.x) * (p.y - a.y) - static_cast<long long>(b.y - a.y) * (p.x - a.x);
+    return cross == 0 && std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x)
+        && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+// The polylines cover exactly the segments: each segment is on one of them and the lengths are the same
+static void expectSameLines(const std::vector<Segment>& segments, const std::vector<std::vector<Point2D>>& polylines) {
+    auto segments_length = 0.0;
+    for (const auto& segment : segments) {
+        segments_length += length(segment.p1, segment.p2);
+        auto found = false;
+        for (const auto& polyline : polylines) {
+            for (size_t k = 1; k < polyline.size() && !found; k++) {
+                found = isOnSegment(segment.p1, polyline[k - 1], polyline[k])
+                    && isOnSegment(segment.p2, polyline[k - 1], polyline[k]);
+            }
+        }
+        EXPECT_TRUE(found) << segment.p1.x << "," << segment.p1.y << " " << segment.p2.x << "," << segment.p2.y;
+    }
+    auto polylines_length = 0.0;
+    for (const auto& polyline : polylines) {
+        EXPECT_GE(polyline.size(), 2u);
+        for (size_t k = 1; k < polyline.size(); k++) {
+            polylines_length += length(polyline[k - 1], polyline[k]);
+        }
+    }
+    EXPECT_NEAR(polylines_length, segments_length, 1e-6);
+}
+
+// Collinear segments are merged, a polyline goes straight on at crossings and turns where it has to
+TEST(PolylinePainterTest, MergeSegments) {
+    // A plus sign with arms of two segments each, in any order and direction, a corner and a dot
+    const std::vector<Segment> segments = {
+        {{0, 0}, {1, 0}}, {{2, 0}, {1, 0}}, {{0, 0}, {-1, 0}}, {{-2, 0}, {-1, 0}},
+        {{0, 1}, {0, 2}}, {{0, 0}, {0, 1}}, {{0, -1}, {0, 0}}, {{0, -2}, {0, -1}},
+        {{10, 10}, {20, 10}}, {{20, 10}, {20, 30}},
+        {{5, 5}, {5, 5}}};
+    const auto polylines = mergeSegments(segments);
+    ASSERT_EQ(polylines.size(), 4u);
+    expectSameLines(segments, polylines);
+    auto vertices = 0;
+    for (const auto& polyline : polylines) {
+        vertices += static_cast<int>(polyline.size());
+    }
+    // 2 straight lines, the corner and the dot
+    EXPECT_EQ(vertices, 2 + 2 + 3 + 2);
+
+    // A square is a closed polyline
+    const std::vector<Segment> square = {{{0, 0}, {0, 1}}, {{1, 1}, {1, 0}}, {{0, 1}, {1, 1}}, {{1, 0}, {0, 0}}};
+    const auto closed = mergeSegments(square);
+    ASSERT_EQ(closed.size(), 1u);
+    EXPECT_EQ(closed[0].size(), 5u);
+    expectSameLines(square, closed);
+
+    EXPECT_TRUE(mergeSegments({}).empty());
+}
+
+// The walls of the grids are drawn as fewer than half as many polylines covering the same lines, the cells are
+// drawn as they are
+template< typename Maze >
+static void testGrid(int edge_count) {
+    Maze m(20, 25);
+    m.AddExits();
+    CreateMazeParams params;
+    params.random_seed = 3;
+    ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+    const DrawParams p = {20, 20, 2, true};
+
+    LineCollector direct;
+    m.Draw(direct, p);
+    LineCollector merged;
+    PolylinePainter painter(merged);
+    m.Draw(painter, p);
+
+    EXPECT_EQ(merged.polys, direct.polys);
+    EXPECT_TRUE(merged.lines.empty());
+    EXPECT_LT(2 * merged.polylines.size(), direct.lines.size()) << edge_count;
+    for (const auto style : {IPainter::EStyle::Wall, IPainter::EStyle::WallBlocked, IPainter::EStyle::Solution}) {
+        std::vector<Segment> segments;
+        for (const auto& line : direct.lines) {
+            if (line.style == style) {
+                segments.push_back(line.segment);
+            }
+        }
+        std::vector<std::vector<Point2D>> polylines;
+        for (const auto& polyline : merged.polylines) {
+            if (polyline.style == style) {
+                polylines.push_back(polyline.vertices);
+            }
+        }
+        EXPECT_FALSE(segments.empty());
+        expectSameLines(segments, polylines);
+    }
+}
+
+TEST(PolylinePainterTest, Grids) {
+    testGrid<SquareMaze>(4);
+    testGrid<HexMaze>(6);
+    testGrid<BrickMaze>(6);
+}
@@ -0,0 +1,78 @@
+#include "src/random.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+// Same output as the reference implementation (pcg32_srandom_r(&rng, 42, 54) in pcg32-demo)
+TEST(RandomTest, Pcg32ReferenceOutput) {
+    Pcg32 engine(42, 54);
+    const std::array<uint32_t, 6> expected = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+    for (const auto value : expected) {
+        EXPECT_EQ(engine(), value);
+    }
+}
+
+// Different streams of the same seed give different sequences
+TEST(RandomTest, Pcg32Streams) {
+    Pcg32 engine1(1, 1);
+    Pcg32 engine2(1, 2);
+    auto same = 0;
+    for (int k = 0; k < 100; k++) {
+        same += engine1() == engine2();
+    }
+    EXPECT_LT(same, 2);
+}
+
+// The mapping is fixed: these values must not change on any platform, mazes depend on them
+TEST(RandomTest, RandomBelowIsReproducible) {
+    Pcg32 engine(1);
+    const std::array<uint32_t, 8> expected = {32, 41, 2, 45, 25, 60, 48, 28};
+    for (const auto value : expected) {
+        EXPECT_EQ(randomBelow(engine, 100), value);
+    }
+}
+
+// All values in the range are returned with about the same frequency
+TEST(RandomTest, RandomBelowUniform) {
+    for (const uint32_t n : {1u, 2u, 3u, 6u, 7u}) {
+        Pcg32 engine(n);
+        const auto samples = 60000;
+        std::vector<int> counts(n, 0);
+        for (int k = 0; k < samples; k++) {
+            const auto value = randomBelow(engine, n);
+            ASSERT_LT(value, n);
+            counts[value]++;
+        }
+        for (const auto count : counts) {
+            EXPECT_NEAR(count, samples / n, samples / n / 20) << n;
+        }
+    }
+}
+
+// Values close to 2^32 are rejected correctly, the result stays in range
+TEST(RandomTest, RandomBelowLargeRange) {
+    std::mt19937 engine(0);
+    const auto n = 0xC0000000u;
+    for (int k = 0; k < 1000; k++) {
+        EXPECT_LT(randomBelow(engine, n), n);
+    }
+}
+
+// The shuffle is a permutation and it is reproducible
+TEST(RandomTest, RandomShuffle) {
+    std::vector<int> values(10);
+    for (int k = 0; k < 10; k++) {
+        values[k] = k;
+    }
+    Pcg32 engine(7);
+    randomShuffle(values.begin(), values.end(), engine);
+    EXPECT_EQ(values, std::vector<int>({5, 4, 7, 1, 9, 0, 6, 3, 8, 2}));
+
+    std::vector<int> empty;
+    randomShuffle(empty.begin(), empty.end(), engine);
+    EXPECT_TRUE(empty.empty());
+}
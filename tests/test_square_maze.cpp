@@ -1,4 +1,5 @@
 #include "src/square_maze.h"
+#include "tests/test_utils.h"
 
 #include <gtest/gtest.h>
 
@@ -146,4 +147,79 @@ INSTANTIATE_TEST_SUITE_P(InvalidCases, SquareMazeNextNodeTest, ::testing::Values
 
 //----------------------------------------------------------------------------------------------------
 
+// The open edge masks follow every edge change, during generation as well
+TEST(SquareMazeTest, OpenEdgeMaskMatchesEdges) {
+    SquareMaze m(5, 6);
+    m.invalidateRegion({1, 1}, {2, 2});
+    m.AddExits();
+    CreateMazeParams params;
+    params.random_seed = 7;
+    ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 6; j++) {
+            EdgeMask expected = 0;
+            for (int e = 1; e <= 4; e++) {
+                const auto state = m.getEdge({i, j}, e);
+                if (state == EEdge::Open || state == EEdge::OnPath) {
+                    expected |= 1 << e;
+                }
+            }
+            EXPECT_EQ(m.getOpenEdgeMask({i, j}), expected) << i << ", " << j;
+        }
+    }
+}
+
+// A reset grid is the same as a new one
+TEST(SquareMazeTest, Reset) {
+    SquareMaze m(4, 5);
+    m.invalidateRegion({1, 1}, {2, 2});
+    m.AddExits();
+    ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+    m.Reset();
+
+    const SquareMaze fresh(4, 5);
+    for (int id = 0; id < m.nodeCount(); id++) {
+        const auto node = m.nodeFromId(id);
+        EXPECT_EQ(m.getNode(node), fresh.getNode(node));
+        EXPECT_EQ(m.getOpenEdgeMask(node), fresh.getOpenEdgeMask(node));
+        for (int e = 1; e <= 4; e++) {
+            EXPECT_EQ(m.getEdge(node, e), fresh.getEdge(node, e)) << id << ", " << e;
+        }
+    }
+    EXPECT_EQ(m.getOpenNode(), fresh.getOpenNode());
+}
+
+// The generators are kept by the grid for its next mazes. Reseeded, they create the same maze as new ones.
+TEST(SquareMazeTest, ReusedGenerators) {
+    for (const auto algorithm : {EMazeAlgorithm::Wilson, EMazeAlgorithm::WilsonArrows, EMazeAlgorithm::Kruskal}) {
+        CreateMazeParams params;
+        params.algorithm = algorithm;
+        SquareMaze m(6, 7);
+        params.random_seed = 1;
+        ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+        m.Reset();
+        params.random_seed = 2;
+        ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+
+        SquareMaze fresh(6, 7);
+        ASSERT_EQ(fresh.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+        for (int id = 0; id < m.nodeCount(); id++) {
+            for (int e = 1; e <= 4; e++) {
+                EXPECT_EQ(m.getEdge(m.nodeFromId(id), e), fresh.getEdge(m.nodeFromId(id), e)) << id << ", " << e;
+            }
+        }
+    }
+
+    // The parallel generator is not deterministic, it is recreated for another number of threads
+    SquareMaze m(6, 7);
+    CreateMazeParams params;
+    for (const auto num_threads : {3, 3, 2}) {
+        params.num_threads = num_threads;
+        m.Reset();
+        ASSERT_EQ(m.CreateMaze(params, nullptr), ECreateMazeResult::Ok);
+        EXPECT_TRUE(isSpanningTree(m, 4));
+    }
+}
+
 // TODO: Test drawing
@@ -0,0 +1,112 @@
+#include "src/square_maze_stream.h"
+#include "src/painter.h"
+
+#include <gtest/gtest.h>
+
+#include <queue>
+#include <set>
+#include <tuple>
+
+// Collects the walls drawn with 1x1 cells and no padding
+class WallCollector : public IPainter
+{
+public:
+    void BeginDraw(int, int) override {}
+    void EndDraw() override {}
+    void DrawLine(const Point2D& p1, const Point2D& p2, EStyle style) override {
+        // Walls are stored by their top-left end and orientation
+        walls.insert({std::min(p1.x, p2.x), std::min(p1.y, p2.y), p1.y == p2.y});
+        if (style == EStyle::WallBlocked) {
+            blocked_walls++;
+        }
+        lines++;
+    }
+    void DrawPoly(const std::vector<Point2D>&, EStyle) override {
+        polys++;
+    }
+
+    bool hasWall(int x, int y, bool horizontal) const {
+        return walls.count({x, y, horizontal}) > 0;
+    }
+
+    std::set<std::tuple<int, int, bool>> walls;
+    int blocked_walls = 0;
+    int lines = 0;
+    int polys = 0;
+};
+
+// The maze is perfect: all cells are reachable and there are no loops
+TEST(SquareMazeStreamTest, PerfectMaze) {
+    const auto rows = 30, cols = 17;
+    for (unsigned seed = 0; seed < 10; seed++) {
+        SquareMazeStream m(rows, cols, seed);
+        WallCollector painter;
+        m.Draw(painter, {1, 1, 0});
+
+        auto passages = 0;
+        std::vector<bool> reached(rows * cols, false);
+        std::queue<std::pair<int, int>> queue;
+        queue.push({0, 0});
+        reached[0] = true;
+        while (!queue.empty()) {
+            const auto [i, j] = queue.front();
+            queue.pop();
+            const std::tuple<int, int, bool, int, int> neighbours[] = {
+                {j, i + 1, true, i + 1, j},     // S
+                {j + 1, i, false, i, j + 1},    // E
+                {j, i, true, i - 1, j},         // N
+                {j, i, false, i, j - 1},        // W
+            };
+            for (const auto& [x, y, horizontal, next_i, next_j] : neighbours) {
+                if (next_i < 0 || next_i >= rows || next_j < 0 || next_j >= cols || painter.hasWall(x, y, horizontal)) {
+                    continue;
+                }
+                passages++;
+                if (!reached[next_i * cols + next_j]) {
+                    reached[next_i * cols + next_j] = true;
+                    queue.push({next_i, next_j});
+                }
+            }
+        }
+        EXPECT_TRUE(std::find(reached.begin(), reached.end(), false) == reached.end());
+        // Each passage was counted from both of its cells
+        EXPECT_EQ(passages, 2 * (rows * cols - 1));
+        EXPECT_EQ(painter.blocked_walls, 2 * (rows + cols));
+        EXPECT_EQ(painter.polys, 0);
+    }
+}
+
+// Exits are opened at the top-left and bottom-right corners
+TEST(SquareMazeStreamTest, Exits) {
+    SquareMazeStream m(4, 5, 0);
+    m.AddExits();
+    WallCollector painter;
+    m.Draw(painter, {1, 1, 0});
+
+    EXPECT_FALSE(painter.hasWall(0, 0, true));
+    EXPECT_FALSE(painter.hasWall(4, 4, true));
+    EXPECT_TRUE(painter.hasWall(1, 0, true));
+    EXPECT_TRUE(painter.hasWall(3, 4, true));
+    EXPECT_EQ(painter.blocked_walls, 2 * (4 + 5) - 2);
+}
+
+// Only the current row is stored, so the number of rows is not limited by memory
+TEST(SquareMazeStreamTest, ManyRows) {
+    const auto rows = 1000000, cols = 3;
+    SquareMazeStream m(rows, cols, 0);
+
+    class LineCounter : public IPainter
+    {
+    public:
+        void BeginDraw(int, int) override {}
+        void EndDraw() override {}
+        void DrawLine(const Point2D&, const Point2D&, EStyle) override { lines++; }
+        void DrawPoly(const std::vector<Point2D>&, EStyle) override {}
+        long lines = 0;
+    } painter;
+    m.Draw(painter, {1, 1, 0});
+
+    // All interior walls minus the passages of the spanning tree, plus the border
+    const long interior = static_cast<long>(rows) * (cols - 1) + static_cast<long>(rows - 1) * cols;
+    EXPECT_EQ(painter.lines, interior - (static_cast<long>(rows) * cols - 1) + 2 * (rows + cols));
+}
@@ -0,0 +1,148 @@
+#include "src/svg_painter.h"
+#include "src/brick_maze.h"
+#include "src/hexmaze.h"
+#include "src/square_maze.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+TEST(SvgPainterTest, Elements) {
+    std::ostringstream os;
+    SvgPainter painter(os, {3});
+    painter.BeginDraw(640, 480);
+    painter.DrawLine({0, -5}, {2147483647, -2147483647 - 1}, IPainter::EStyle::Wall);
+    painter.DrawPoly({{1, 2}, {30, 40}, {-500, 600}}, IPainter::EStyle::VisitedCell);
+    painter.EndDraw();
+    EXPECT_EQ(os.str(),
+              "<!DOCTYPE svg>\n"
+              "<svg height=\"480\" width=\"640\" xmlns=\"http://www.w3.org/2000/svg\" style=\"background-color:white\">\n"
+              "<line x1=\"0\" y1=\"-5\" x2=\"2147483647\" y2=\"-2147483648\" style=\"stroke:black;stroke-width:3;stroke-linecap:round\" />\n"
+              "<polygon points=\"1,2 30,40 -500,600 \" style=\"fill:white\" />\n"
+              "</svg>\n");
+}
+
+// The buffer is written in chunks while drawing, and all of it at EndDraw or when the painter is destroyed
+TEST(SvgPainterTest, Flush) {
+    std::ostringstream os;
+    const std::string line = "<line x1=\"100\" y1=\"200\" x2=\"300\" y2=\"400\" style=\"stroke:red;stroke-width:1;stroke-linecap:round\" />\n";
+    const auto line_count = static_cast<int>(2 * SvgPainter::BUFFER_SIZE / line.size());
+    {
+        SvgPainter painter(os, {1});
+        for (int k = 0; k < line_count; k++) {
+            painter.DrawLine({100, 200}, {300, 400}, IPainter::EStyle::WallBlocked);
+        }
+        EXPECT_GE(os.str().size(), SvgPainter::BUFFER_SIZE);
+        EXPECT_LT(os.str().size(), line_count * line.size());
+    }
+    EXPECT_EQ(os.str().size(), line_count * line.size());
+    EXPECT_EQ(os.str().substr(0, line.size()), line);
+}
+
+// Polylines are paths, single segments are lines
+TEST(SvgPainterTest, Polylines) {
+    std::ostringstream os;
+    SvgPainter painter(os, {2});
+    painter.DrawPolyline({{0, 0}, {10, 0}, {10, -20}}, IPainter::EStyle::Solution);
+    painter.DrawPolyline({{5, 5}, {6, 6}}, IPainter::EStyle::Wall);
+    painter.EndDraw();
+    EXPECT_EQ(os.str(),
+              "<path fill=\"none\" stroke-linejoin=\"round\" d=\"M0,0 10,0 10,-20\" style=\"stroke:blue;stroke-width:2;stroke-linecap:round\" />\n"
+              "<line x1=\"5\" y1=\"5\" x2=\"6\" y2=\"6\" style=\"stroke:black;stroke-width:2;stroke-linecap:round\" />\n"
+              "</svg>\n");
+}
+
+// A path per style with relative coordinates, in the order of the styles, the styles are classes
+TEST(SvgPainterTest, Layers) {
+    std::ostringstream os;
+    SvgPainter painter(os, {2}, ESvgMode::Layers);
+    painter.BeginDraw(100, 50);
+    painter.DrawLine({0, 0}, {10, 0}, IPainter::EStyle::Wall);
+    painter.DrawPoly({{0, 0}, {10, 0}, {10, 10}, {0, 10}}, IPainter::EStyle::VisitedCell);
+    painter.DrawPoly({{10, 0}, {20, 0}, {20, 10}, {10, 10}}, IPainter::EStyle::VisitedCell);
+    painter.DrawPolyline({{0, 10}, {0, 20}, {-5, 20}}, IPainter::EStyle::Wall);
+    painter.EndDraw();
+    EXPECT_EQ(os.str(),
+              "<!DOCTYPE svg>\n"
+              "<svg height=\"50\" width=\"100\" xmlns=\"http://www.w3.org/2000/svg\" style=\"background-color:white\">\n"
+              "<style>\n"
+              ".open{fill:darkgray}\n"
+              ".visited{fill:white}\n"
+              ".on-path{fill:lightgray}\n"
+              ".wall{stroke:black;stroke-width:2;stroke-linecap:round;fill:none;stroke-linejoin:round}\n"
+              ".blocked{stroke:red;stroke-width:2;stroke-linecap:round;fill:none;stroke-linejoin:round}\n"
+              ".solution{stroke:blue;stroke-width:2;stroke-linecap:round;fill:none;stroke-linejoin:round}\n"
+              "</style>\n"
+              "<path class=\"visited\" d=\"M0,0l10,0 0,10 -10,0zM10,0l10,0 0,10 -10,0z\" />\n"
+              "<path class=\"wall\" d=\"M0,0l10,0M0,10l0,10 -5,0\" />\n"
+              "</svg>\n");
+}
+
+// The number of elements of a maze does not depend on its size
+TEST(SvgPainterTest, LayersElementCount) {
+    HexMaze m(30, 40);
+    m.AddExits();
+    ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+    std::ostringstream os;
+    SvgPainter painter(os, {2}, ESvgMode::Layers);
+    m.Draw(painter, {20, 20, 2, true});
+    const auto svg = os.str();
+    auto elements = 0;
+    for (auto pos = svg.find('<'); pos != std::string::npos; pos = svg.find('<', pos + 1)) {
+        elements += svg[pos + 1] != '/';
+    }
+    // DOCTYPE, svg, style and the paths of the visited cells, the walls, the blocked walls and the solution
+    EXPECT_EQ(elements, 7);
+}
+
+// Counts the elements drawn with each style
+class StyleCounter : public IPainter
+{
+public:
+    void BeginDraw(int, int) override {}
+    void EndDraw() override {}
+    void DrawLine(const Point2D&, const Point2D&, EStyle style) override {
+        counts[static_cast<int>(style)]++;
+    }
+    void DrawPoly(const std::vector<Point2D>&, EStyle style) override {
+        counts[static_cast<int>(style)]++;
+    }
+
+    int counts[STYLE_COUNT] = {};
+};
+
+// The print profile draws everything but the visited cells
+template< typename Maze >
+static void testRenderProfiles() {
+    Maze m(12, 15);
+    m.invalidateRegion({3, 3}, {5, 6});
+    m.AddExits();
+    ASSERT_EQ(m.CreateMaze({}, nullptr), ECreateMazeResult::Ok);
+    m.setNode({0, 0}, ENode::OnPath);
+
+    DrawParams p = {20, 20, 2, true};
+    StyleCounter debug;
+    m.Draw(debug, p);
+    p.profile = ERenderProfile::Print;
+    StyleCounter print;
+    m.Draw(print, p);
+
+    for (int style = 0; style < IPainter::STYLE_COUNT; style++) {
+        if (static_cast<IPainter::EStyle>(style) == IPainter::EStyle::VisitedCell) {
+            EXPECT_GT(debug.counts[style], 0);
+            EXPECT_EQ(print.counts[style], 0);
+        } else {
+            EXPECT_EQ(print.counts[style], debug.counts[style]) << style;
+        }
+    }
+    // The masked cells and the cell on a walk
+    EXPECT_EQ(print.counts[static_cast<int>(IPainter::EStyle::OpenCell)], 12);
+    EXPECT_EQ(print.counts[static_cast<int>(IPainter::EStyle::OnPathCell)], 1);
+}
+
+TEST(SvgPainterTest, RenderProfiles) {
+    testRenderProfiles<SquareMaze>();
+    testRenderProfiles<HexMaze>();
+    testRenderProfiles<BrickMaze>();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "src/gen_wilson.h"
+
+#include <map>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Builds a maze by hand: all nodes are visited and the given edges (node and edge index) are in the maze
+template< typename Maze >
+void buildMaze(Maze& m, const std::vector<std::pair<typename Maze::NodeIndex, int>>& edges) {
+    for (int id = 0; id < m.nodeCount(); id++) {
+        m.setNode(m.nodeFromId(id), ENode::Visited);
+    }
+    for (const auto& [node, edge] : edges) {
+        m.setEdge(node, edge, EEdge::Visited);
+    }
+}
+
+// Returns true if the visited edges of `m` form a spanning tree of its valid nodes. Exits are ignored.
+template< typename Maze >
+bool isSpanningTree(const Maze& m, int edge_count) {
+    auto valid_nodes = 0;
+    auto start = -1;
+    for (int id = 0; id < m.nodeCount(); id++) {
+        if (m.getNode(m.nodeFromId(id)) != ENode::Invalid) {
+            valid_nodes++;
+            start = start < 0 ? id : start;
+        }
+    }
+    if (start < 0) {
+        return false;
+    }
+
+    auto reached_nodes = 1;
+    auto visited_edges = 0;
+    std::vector<bool> reached(m.nodeCount(), false);
+    std::queue<typename Maze::NodeIndex> queue;
+    queue.push(m.nodeFromId(start));
+    reached[start] = true;
+    while (!queue.empty()) {
+        const auto node = queue.front();
+        queue.pop();
+        for (int edge = 1; edge <= edge_count; edge++) {
+            if (m.getEdge(node, edge) != EEdge::Visited) {
+                continue;
+            }
+            const auto next = Maze::nextNode(node, edge);
+            if (next.i < 0 || next.i >= m.rows() || next.j < 0 || next.j >= m.cols()) {
+                continue; // Exit
+            }
+            visited_edges++;
+            if (!reached[m.nodeId(next)]) {
+                reached[m.nodeId(next)] = true;
+                reached_nodes++;
+                queue.push(next);
+            }
+        }
+    }
+    // Each edge was counted from both of its nodes
+    return reached_nodes == valid_nodes && visited_edges == 2 * (valid_nodes - 1);
+}
+
+// Encodes the spanning tree of a small SquareMaze as a bit mask of its visited S and E edges
+template< typename Maze >
+int treeKey(const Maze& m) {
+    auto key = 0;
+    for (int id = 0; id < m.nodeCount(); id++) {
+        for (int edge = 1; edge <= 2; edge++) {
+            if (m.getEdge(m.nodeFromId(id), edge) == EEdge::Visited) {
+                key |= 1 << (2*id + edge - 1);
+            }
+        }
+    }
+    return key;
+}
+
+// Pearson's chi-squared statistic of the observed counts against the uniform distribution
+inline double chiSquared(const std::map<int, int>& counts, int categories, int samples) {
+    const auto expected = static_cast<double>(samples) / categories;
+    auto chi2 = (categories - static_cast<int>(counts.size())) * expected;
+    for (const auto& [key, count] : counts) {
+        chi2 += (count - expected) * (count - expected) / expected;
+    }
+    return chi2;
+}
+
+// Generator observer counting the events (see NullMazeObserver)
+struct CountingObserver
+{
+    template< typename NodeIndex >
+    void onEvent(const NodeChangedEvent<NodeIndex>&) { node_changes++; }
+    template< typename NodeIndex >
+    void onEvent(const EdgeChangedEvent<NodeIndex>&) { edge_changes++; }
+    template< typename NodeIndex >
+    void onEvent(const WalkStartedEvent<NodeIndex>&) { walks++; }
+    template< typename NodeIndex >
+    void onEvent(const LoopErasedEvent<NodeIndex>& event) {
+        loops++;
+        erased_steps += event.length;
+    }
+
+    int node_changes = 0;
+    int edge_changes = 0;
+    int walks = 0;
+    int loops = 0;
+    long long erased_steps = 0;
+};